@@ -0,0 +1,78 @@
+#pragma once
+
+#include <spang/dfs.hpp>
+#include <spang/graph.hpp>
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <iostream>
+#include <span>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+namespace spang
+{
+
+/*!
+A pattern as stored in the binary output format. See the README for the layout of the format.
+*/
+struct binary_pattern_t
+{
+	graph_id_t id;
+	std::vector<dfs_edge_t> codes;
+	std::size_t support;
+	//! The IDs of the graphs the pattern is in, in increasing order, or none if they were not
+	//! written.
+	std::vector<graph_id_t> graph_ids;
+
+	bool operator==(const binary_pattern_t&) const = default;
+};
+
+//! The bytes every binary output file starts with.
+inline constexpr std::string_view binary_output_magic = "SPANGPAT";
+
+/*!
+Writes patterns in the binary output format. Patterns are gathered into blocks, each with its own
+label dictionary, and a block is written once it holds block_size patterns, on flush(), or on
+destruction. Not safe to call from several threads at once.
+*/
+class binary_pattern_writer
+{
+  public:
+	explicit binary_pattern_writer(std::ostream& out, std::size_t block_size = 4096);
+	~binary_pattern_writer();
+
+	binary_pattern_writer(const binary_pattern_writer&) = delete;
+	binary_pattern_writer& operator=(const binary_pattern_writer&) = delete;
+
+	//! Adds a pattern. graph_ids must be in increasing order with no ID repeated, and may be left
+	//! empty.
+	void write(graph_id_t id, std::span<const dfs_edge_t> codes, std::size_t support,
+	           std::span<const graph_id_t> graph_ids);
+
+	//! Writes the current block, if it holds any patterns.
+	void flush();
+
+  private:
+	[[nodiscard]] std::uint64_t label_index(int label);
+
+	std::ostream& out_;
+	std::size_t block_size_;
+
+	std::size_t n_patterns{0};
+	graph_id_t last_id{0};
+	std::vector<int> labels;
+	std::unordered_map<int, std::uint64_t> label_indexes;
+	std::vector<std::uint8_t> records;
+};
+
+/*!
+Reads patterns from a stream in the binary output format, passing each to on_pattern as soon as it
+has been read, so that only one block is held in memory at a time.
+*/
+void read_binary_patterns(std::istream& stream,
+                          const std::function<void(binary_pattern_t&&)>& on_pattern);
+
+} // namespace spang
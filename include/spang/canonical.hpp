@@ -0,0 +1,110 @@
+#pragma once
+
+#include <spang/dfs.hpp>
+#include <spang/graph.hpp>
+#include <spang/parser.hpp>
+
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <unordered_map>
+#include <vector>
+
+namespace spang
+{
+
+/*!
+Converts a graph read from an output file, whose vertex IDs may be arbitrary, to a graph_t with
+vertices indexed by their position.
+*/
+[[nodiscard]] graph_t to_graph(const parsed_output_graph_base_t& parsed);
+
+/*!
+The minimal DFS code of a graph read from an output file, which is the same however its vertices
+were numbered. The graph must be connected, as all output patterns are.
+*/
+[[nodiscard]] std::vector<dfs_edge_t> canonical_code(const parsed_output_graph_base_t& parsed);
+
+//! Hashes a whole DFS code, so that canonical codes can be used as keys.
+struct dfs_code_hash
+{
+	std::size_t operator()(std::span<const dfs_edge_t> codes) const;
+};
+
+/*!
+A graph up to isomorphism: its canonical code, or, for a graph without edges (which has no code),
+the sorted labels of its vertices.
+*/
+struct canonical_form_t
+{
+	std::vector<dfs_edge_t> code;
+	std::vector<vertex_label_t> vertex_labels;
+
+	bool operator==(const canonical_form_t&) const = default;
+};
+
+[[nodiscard]] canonical_form_t canonical_form(const parsed_output_graph_base_t& parsed);
+
+/*!
+Remembers the canonical forms of graphs, keyed by their vertices and edges as written, so that
+repeats of a graph (such as the same pattern in both results being compared) are canonicalised only
+once. Once max_size forms are held, the cache is emptied and starts again.
+*/
+class canonical_cache
+{
+  public:
+	explicit canonical_cache(std::size_t max_size = std::size_t{1} << 20) : max_size_{max_size} {}
+
+	//! The canonical form of the graph. The support list is ignored.
+	const canonical_form_t& get(const parsed_output_graph_base_t& parsed);
+
+	[[nodiscard]] std::size_t size() const { return forms.size(); }
+
+  private:
+	struct literal_graph_t
+	{
+		std::vector<parsed_vertex_t> vertices;
+		std::vector<parsed_edge_t> edges;
+
+		bool operator==(const literal_graph_t&) const = default;
+	};
+
+	struct literal_graph_hash
+	{
+		std::size_t operator()(const literal_graph_t& graph) const;
+	};
+
+	std::size_t max_size_;
+	std::unordered_map<literal_graph_t, canonical_form_t, literal_graph_hash> forms;
+};
+
+/*!
+A 128-bit hash of a pattern's canonical form and support, such that isomorphic patterns
+with the same support have the same fingerprint, and any others almost certainly do not.
+*/
+struct fingerprint_t
+{
+	std::uint64_t low, high;
+
+	bool operator==(const fingerprint_t&) const = default;
+	auto operator<=>(const fingerprint_t&) const = default;
+};
+
+struct fingerprint_hash
+{
+	std::size_t operator()(const fingerprint_t& fingerprint) const
+	{
+		// Already well mixed.
+		return static_cast<std::size_t>(fingerprint.low);
+	}
+};
+
+//! support_count is the support as reported, and support the sorted IDs of the graphs the pattern
+//! is in, which may be empty if they were not reported.
+[[nodiscard]] fingerprint_t fingerprint(const canonical_form_t& form, std::size_t support_count,
+                                      std::span<const graph_id_t> support);
+
+//! The fingerprint of a graph read from an output file, with its support list in any order.
+[[nodiscard]] fingerprint_t fingerprint(const parsed_output_graph_base_t& parsed);
+
+} // namespace spang
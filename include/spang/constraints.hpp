@@ -0,0 +1,65 @@
+#pragma once
+
+#include <spang/dfs.hpp>
+#include <spang/graph.hpp>
+
+#include <cstddef>
+#include <limits>
+#include <optional>
+#include <span>
+#include <string_view>
+#include <vector>
+
+namespace spang
+{
+
+/*!
+Limits on which patterns are wanted, applied during the search rather than to its output.
+
+The anti-monotone ones hold for every subgraph of a pattern that meets them, so the search never
+grows a pattern that breaks one: their labels are removed in preprocessing, and extensions that
+break the size or degree limits are dropped before their support is counted.
+
+The monotone ones hold for every supergraph of a pattern that meets them, so they cannot prune the
+search, and only decide whether a pattern is reported. Graphs without every required label are
+still removed in preprocessing, as no reported pattern can occur in them.
+*/
+struct constraints_t
+{
+	static constexpr std::size_t no_limit = std::numeric_limits<std::size_t>::max();
+
+	// Anti-monotone
+	std::size_t max_edges = no_limit;
+	//! The most edges any one pattern vertex may have.
+	std::size_t max_degree = no_limit;
+	std::vector<vertex_label_t> forbidden_vertex_labels;
+	std::vector<edge_label_t> forbidden_edge_labels;
+
+	// Monotone
+	std::vector<vertex_label_t> required_vertex_labels;
+	std::vector<edge_label_t> required_edge_labels;
+
+	[[nodiscard]] bool allows_vertex_label(vertex_label_t label) const;
+	[[nodiscard]] bool allows_edge_label(edge_label_t label) const;
+
+	/*!
+	Whether adding code to a pattern stays within the anti-monotone limits. n_edges is the number of
+	edges of the pattern, and degrees the degree of each of its vertices, which can be left empty if
+	there is no degree limit.
+	*/
+	[[nodiscard]] bool allows_extension(std::span<const std::size_t> degrees, std::size_t n_edges,
+	                                    const dfs_edge_t& code) const;
+
+	//! Whether the pattern given by codes has every required label.
+	[[nodiscard]] bool satisfied_by(std::span<const dfs_edge_t> codes) const;
+};
+
+/*!
+Parses constraints from a comma separated list of key=value items, with keys max_edges,
+max_degree, forbid_vertex, forbid_edge, require_vertex and require_edge, for example
+"max_edges=5,forbid_vertex=3,forbid_vertex=4". The label keys can be given any number of times.
+An empty string gives no constraints.
+*/
+[[nodiscard]] std::optional<constraints_t> parse_constraints(std::string_view spec);
+
+} // namespace spang
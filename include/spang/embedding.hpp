@@ -0,0 +1,165 @@
+#pragma once
+
+#include <spang/dfs.hpp>
+#include <spang/graph.hpp>
+
+#include <algorithm>
+#include <cassert>
+#include <limits>
+#include <span>
+#include <vector>
+
+namespace spang
+{
+
+/*!
+An alternative to chains of projection links, in the style of Gaston and FSG. Each embedding of a
+pattern is stored as a row: the graph vertex each DFS vertex maps to, and the graph edge each DFS
+edge maps to, indexed by DFS vertex and DFS code index respectively. All rows have the same
+length, so they are stored back to back, and an embedding can be read without chasing pointers or
+building a view.
+
+The tradeoff is memory, as each row is a full copy of its parent row plus one more edge, whereas
+a projection link only stores the new edge.
+
+Rows are expected to be added grouped by graph, as extension does. Graph vertex and edge IDs are
+stored as local_id_t.
+*/
+template <class local_id_t>
+class basic_embedding_list
+{
+  public:
+	std::size_t size() const { return graph_ids.size(); }
+	bool empty() const { return graph_ids.empty(); }
+
+	//! The number of vertices and edges in each row.
+	std::size_t n_vertices() const { return n_vertices_; }
+	std::size_t n_edges() const { return n_edges_; }
+
+	graph_id_t graph_id(const std::size_t row) const { return graph_ids[row]; }
+
+	std::span<const local_id_t> vertices(const std::size_t row) const
+	{
+		return std::span{rows}.subspan(row * stride(), n_vertices_);
+	}
+
+	std::span<const local_id_t> edges(const std::size_t row) const
+	{
+		return std::span{rows}.subspan(row * stride() + n_vertices_, n_edges_);
+	}
+
+	//! Adds an embedding of a 1-edge pattern.
+	void push_back(const graph_id_t graph_id, const local_id_t from, const local_id_t to,
+	               const local_id_t edge)
+	{
+		assert(empty() || (n_vertices_ == 2 && n_edges_ == 1));
+		n_vertices_ = 2;
+		n_edges_ = 1;
+		graph_ids.push_back(graph_id);
+		rows.insert(rows.end(), {from, to, edge});
+	}
+
+	/*!
+	Adds an embedding that extends a row of the parent list by one edge, and by one vertex if
+	new_vertex is not no_vertex (that is, if the edge is forwards).
+	*/
+	void push_back(const basic_embedding_list& parent, const std::size_t row, const local_id_t edge,
+	               const local_id_t new_vertex)
+	{
+		const auto n_new_vertices = parent.n_vertices_ + (new_vertex != no_vertex);
+		assert(empty() || (n_vertices_ == n_new_vertices && n_edges_ == parent.n_edges_ + 1));
+		n_vertices_ = n_new_vertices;
+		n_edges_ = parent.n_edges_ + 1;
+
+		graph_ids.push_back(parent.graph_ids[row]);
+		const auto parent_vertices = parent.vertices(row);
+		const auto parent_edges = parent.edges(row);
+		const auto start = static_cast<std::ptrdiff_t>(rows.size());
+		rows.resize(rows.size() + stride());
+		auto out = std::ranges::copy(parent_vertices, rows.begin() + start).out;
+		if (new_vertex != no_vertex)
+		{
+			*out++ = new_vertex;
+		}
+		out = std::ranges::copy(parent_edges, out).out;
+		*out = edge;
+	}
+
+	//! The number of distinct graphs the embeddings are in.
+	std::size_t support() const
+	{
+		std::size_t support = 0;
+		for (std::size_t row = 0; row < graph_ids.size(); ++row)
+		{
+			support += row == 0 || graph_ids[row] != graph_ids[row - 1];
+		}
+		return support;
+	}
+
+	constexpr static local_id_t no_vertex = std::numeric_limits<local_id_t>::max();
+
+  private:
+	std::size_t stride() const { return n_vertices_ + n_edges_; }
+
+	std::size_t n_vertices_{0};
+	std::size_t n_edges_{0};
+
+	// Per row
+	std::vector<graph_id_t> graph_ids;
+	//! Each row is the vertices followed by the edges. Vertex and edge IDs have the same type, so
+	//! both fit in one array.
+	std::vector<local_id_t> rows;
+};
+
+using embedding_list = basic_embedding_list<vertex_id_t>;
+
+/*!
+Gives a single row of an embedding list the same interface as a projection_view, so the same
+extension code can run over both.
+*/
+template <class local_id_t>
+class basic_embedding_view
+{
+  public:
+	basic_embedding_view(const basic_embedding_list<local_id_t>& list, const std::size_t row,
+	                     const std::span<const dfs_edge_t> codes)
+		: vertices{list.vertices(row)}, edges{list.edges(row)}, dfs_code_list{codes}
+	{
+		assert(edges.size() == dfs_code_list.size());
+	}
+
+	bool has_edge(const local_id_t id) const { return std::ranges::find(edges, id) != edges.end(); }
+	bool has_vertex(const local_id_t id) const
+	{
+		return std::ranges::find(vertices, id) != vertices.end();
+	}
+
+	//! Gets the DFS vertex a graph vertex is mapped to, or no_vertex if it is not in the row.
+	vertex_id_t dfs_vertex(const local_id_t id) const
+	{
+		const auto found = std::ranges::find(vertices, id);
+		return found == vertices.end() ? no_vertex
+		                               : static_cast<vertex_id_t>(found - vertices.begin());
+	}
+
+	//! Gets the edge that the given DFS code maps to.
+	basic_edge_t<local_id_t> get_edge(const edge_id_t id) const
+	{
+		const auto& code = dfs_code_list[id];
+		return basic_edge_t<local_id_t>{.from = vertices[code.from],
+		              .to = vertices[code.to],
+		              .label = code.edge_label,
+		              .id = edges[id]};
+	}
+
+	constexpr static vertex_id_t no_vertex = std::numeric_limits<vertex_id_t>::max();
+
+  private:
+	std::span<const local_id_t> vertices;
+	std::span<const local_id_t> edges;
+	std::span<const dfs_edge_t> dfs_code_list;
+};
+
+using embedding_view = basic_embedding_view<vertex_id_t>;
+
+} // namespace spang
@@ -1,11 +1,14 @@
 #pragma once
 
 #include <spang/dfs.hpp>
+#include <spang/embedding.hpp>
 #include <spang/preprocess.hpp>
 #include <spang/projection.hpp>
+#include <spang/scheduler.hpp>
 #include <spang/utility.hpp>
 
 #include <span>
+#include <type_traits>
 // TODO probably want a faster map, can also try std::map
 #include <unordered_map>
 
@@ -28,15 +31,113 @@ struct dfs_edge_hash
 	}
 };
 
-using extension_map =
-	std::unordered_map<dfs_edge_t, std::vector<dfs_projection_link>, dfs_edge_hash>;
+template <class local_id_t>
+using basic_extension_map = std::unordered_map<dfs_edge_t,
+                                               std::vector<basic_dfs_projection_link<local_id_t>>,
+                                               dfs_edge_hash>;
+using extension_map = basic_extension_map<vertex_id_t>;
+
+template <class local_id_t>
+using basic_embedding_extension_map =
+	std::unordered_map<dfs_edge_t, basic_embedding_list<local_id_t>, dfs_edge_hash>;
+using embedding_extension_map = basic_embedding_extension_map<vertex_id_t>;
+
+/*
+Find the 1-edge codes within a given database that could start a minimal dfs code sequence.
+
+Given a scheduler, large databases are split into ranges of graphs, run by the calling thread and
+any idle threads of the scheduler (see task_scheduler::run_parts()). The projections of each code
+are in the same order regardless of the number of threads.
+*/
+template <class local_id_t>
+basic_extension_map<local_id_t>
+extend(const std::span<const basic_compact_graph_t<local_id_t>> graphs,
+       task_scheduler* scheduler = nullptr);
+
+template <class local_id_t>
+basic_extension_map<local_id_t> extend(const basic_graph_database<local_id_t>& graphs,
+                                       task_scheduler* scheduler = nullptr)
+{
+	return extend(std::span<const basic_compact_graph_t<local_id_t>>{graphs}, scheduler);
+}
+
+//! extend() only gives each thread at least this many subinstances, as below this, handing them
+//! to another thread costs more than it saves.
+constexpr std::size_t min_subinstances_per_thread = 1024;
+
+//! Projections to extend, as a span that is left out of template argument deduction, so that any
+//! contiguous container of them can be given.
+template <class local_id_t>
+using subinstance_span =
+	std::type_identity_t<std::span<const basic_dfs_projection_link<local_id_t>>>;
 
 /*
 Find extensions of a dfs code sequence within a given database.
+
+Given a scheduler, large sets of subinstances are split evenly between the calling thread and any
+idle threads of the scheduler. The projections of each extension are in the same order regardless
+of the number of threads.
+*/
+template <class local_id_t>
+basic_extension_map<local_id_t>
+extend(const std::span<const basic_compact_graph_t<local_id_t>> graphs,
+       const std::span<const dfs_edge_t> dfs_code_list,
+       const subinstance_span<local_id_t> subinstances,
+       const std::span<const edge_id_t> rightmost_path, task_scheduler* scheduler = nullptr);
+
+/*
+The templates above cannot deduce the ID width from a container of graphs, such as a
+std::vector<compact_graph_t>. These take graphs of the default width from anything that converts
+to a span of them.
 */
-extension_map extend(const std::span<const compact_graph_t> graphs,
-                     const std::span<const dfs_edge_t> dfs_code_list,
-                     const std::span<const dfs_projection_link> subinstances,
-                     const std::span<const edge_id_t> rightmost_path);
+inline extension_map extend(const std::span<const compact_graph_t> graphs,
+                            task_scheduler* scheduler = nullptr)
+{
+	return extend<vertex_id_t>(graphs, scheduler);
+}
+
+inline extension_map extend(const std::span<const compact_graph_t> graphs,
+                            const std::span<const dfs_edge_t> dfs_code_list,
+                            const std::span<const dfs_projection_link> subinstances,
+                            const std::span<const edge_id_t> rightmost_path,
+                            task_scheduler* scheduler = nullptr)
+{
+	return extend<vertex_id_t>(graphs, dfs_code_list, subinstances, rightmost_path, scheduler);
+}
+
+/*
+As extend, with embeddings stored in embedding lists rather than as chains of projection links.
+*/
+template <class local_id_t>
+basic_embedding_extension_map<local_id_t>
+extend_embeddings(const std::span<const basic_compact_graph_t<local_id_t>> graphs);
+
+template <class local_id_t>
+basic_embedding_extension_map<local_id_t>
+extend_embeddings(const basic_graph_database<local_id_t>& graphs)
+{
+	return extend_embeddings(std::span<const basic_compact_graph_t<local_id_t>>{graphs});
+}
+
+template <class local_id_t>
+basic_embedding_extension_map<local_id_t>
+extend_embeddings(const std::span<const basic_compact_graph_t<local_id_t>> graphs,
+                  const std::span<const dfs_edge_t> dfs_code_list,
+                  const basic_embedding_list<local_id_t>& embeddings,
+                  const std::span<const edge_id_t> rightmost_path);
+
+//! As the extend() overloads for the default width.
+inline embedding_extension_map extend_embeddings(const std::span<const compact_graph_t> graphs)
+{
+	return extend_embeddings<vertex_id_t>(graphs);
+}
+
+inline embedding_extension_map extend_embeddings(const std::span<const compact_graph_t> graphs,
+                                                 const std::span<const dfs_edge_t> dfs_code_list,
+                                                 const embedding_list& embeddings,
+                                                 const std::span<const edge_id_t> rightmost_path)
+{
+	return extend_embeddings<vertex_id_t>(graphs, dfs_code_list, embeddings, rightmost_path);
+}
 
 } // namespace spang
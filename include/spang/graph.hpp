@@ -2,6 +2,7 @@
 
 #include <cassert>
 #include <cstdint>
+#include <type_traits>
 #include <vector>
 
 namespace spang
@@ -13,17 +14,27 @@ using edge_id_t = std::uint16_t;
 using vertex_label_t = int;
 using edge_label_t = int;
 
-struct edge_t
+/*!
+Vertex and edge IDs within an input graph are stored as local_id_t, which can be any of
+std::uint8_t, std::uint16_t or std::uint32_t, so that databases of small graphs take less memory
+and databases of very large ones can still be mined. Patterns themselves (DFS codes and min graphs)
+always use vertex_id_t and edge_id_t.
+*/
+template <class local_id_t>
+struct basic_edge_t
 {
 	// Note: These are indexes of the vertices, which
 	// might not necessarily be the ID of that vertex.
-	vertex_id_t from, to;
+	local_id_t from, to;
 	edge_label_t label;
-	edge_id_t id;
+	local_id_t id;
 
-	[[nodiscard]] constexpr bool operator==(const edge_t&) const = default;
+	[[nodiscard]] constexpr bool operator==(const basic_edge_t&) const = default;
 };
 
+static_assert(std::is_same_v<vertex_id_t, edge_id_t>);
+using edge_t = basic_edge_t<vertex_id_t>;
+
 struct vertex_t
 {
 	vertex_label_t label;
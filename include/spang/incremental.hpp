@@ -0,0 +1,60 @@
+#pragma once
+
+#include <spang/canonical.hpp>
+#include <spang/dfs.hpp>
+#include <spang/preprocess.hpp>
+#include <spang/report.hpp>
+
+#include <cstddef>
+#include <filesystem>
+#include <span>
+#include <unordered_map>
+#include <vector>
+
+namespace spang
+{
+
+/*!
+The patterns found by an earlier run, by their minimal DFS codes, each with the input IDs of the
+graphs it occurs in, in increasing order.
+*/
+using previous_results =
+	std::unordered_map<std::vector<dfs_edge_t>, std::vector<graph_id_t>, dfs_code_hash>;
+
+/*!
+Reads the results of an earlier run from a file in the text output format. Every pattern must have
+its list of graph IDs, as written at the graph_ids report level.
+*/
+[[nodiscard]] auto read_previous_results(const std::filesystem::path& path) -> previous_results;
+
+/*!
+Mines every subgraph with a support of at least min_freq in old_graphs and new_graphs together,
+given the previous results of mining old_graphs alone with the same min_freq. Reports each one to
+sink with the detail given by level, as mine() does.
+
+Only the new graphs are searched: every pattern that gains support, or becomes frequent, occurs in
+one of them. The support a pattern has in the old graphs is taken from the previous results, or, if
+it was not frequent there, found by matching it against only the old graphs its parent occurs in,
+so the work done in the old graphs is limited to the border of the previous results. Previous
+patterns that do not occur in any new graph are reported as they were, once the search is done.
+
+Runs on a single thread. The graphs should have been preprocessed together, so that labels are
+pruned by their frequency across both.
+*/
+template <class local_id_t>
+void mine_incremental(const std::span<const basic_compact_graph_t<local_id_t>> old_graphs,
+                      const std::span<const basic_compact_graph_t<local_id_t>> new_graphs,
+                      const previous_results& previous, const std::size_t min_freq,
+                      const report_level level = report_level::graph_ids,
+                      report_sink& sink = default_report_sink());
+
+/*!
+As above, for a database of whichever ID width it was preprocessed with, holding the old graphs
+followed by the new ones, with n_old_graphs old ones.
+*/
+void mine_incremental(const any_graph_database& graphs, std::size_t n_old_graphs,
+                      const previous_results& previous, std::size_t min_freq,
+                      report_level level = report_level::graph_ids,
+                      report_sink& sink = default_report_sink());
+
+} // namespace spang
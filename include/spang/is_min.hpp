@@ -6,6 +6,7 @@
 #include <optional>
 #include <span>
 #include <utility>
+#include <vector>
 
 namespace spang
 {
@@ -17,4 +18,10 @@ the DFS code sequence is minimal, otherwise returns nothing.
 auto is_min(const std::span<const dfs_edge_t> dfs_code_list)
 	-> std::optional<std::pair<std::vector<edge_id_t>, graph_t>>;
 
+/*!
+Returns the minimal DFS code of a connected graph, which is the same for every graph isomorphic to
+it. Edge IDs in the graph must be in [0, n_edges).
+*/
+auto min_dfs_code(const graph_t& graph) -> std::vector<dfs_edge_t>;
+
 } // namespace spang
@@ -0,0 +1,49 @@
+#pragma once
+
+#include <spang/graph.hpp>
+#include <spang/preprocess.hpp>
+
+#include <cstddef>
+#include <span>
+
+namespace spang
+{
+
+/*!
+Instruction sets the label filter can run with, from least to most capable.
+*/
+enum class simd_level
+{
+	scalar,
+	avx2,
+	avx512,
+};
+
+//! The most capable instruction set supported by both this build and the running CPU.
+[[nodiscard]] simd_level detect_simd_level();
+
+[[nodiscard]] const char* to_string(simd_level level);
+
+/*!
+Candidate filter used when scanning adjacency lists. Writes first + i to out for every i with
+labels[i] >= min_label, in increasing order, and returns how many were written. out must have room
+for at least labels.size() entries.
+
+Uses the most capable instruction set available, detected on the first call.
+*/
+std::size_t filter_labels_at_least(const std::span<const vertex_label_t> labels,
+                                   const vertex_label_t min_label,
+                                   const compact_graph_t::adjacency_index_t first,
+                                   const std::span<compact_graph_t::adjacency_index_t> out);
+
+/*!
+As above, with the given instruction set. Levels the running CPU does not support are lowered to
+the most capable one it does, so this is always safe to call.
+*/
+std::size_t filter_labels_at_least(const simd_level level,
+                                   const std::span<const vertex_label_t> labels,
+                                   const vertex_label_t min_label,
+                                   const compact_graph_t::adjacency_index_t first,
+                                   const std::span<compact_graph_t::adjacency_index_t> out);
+
+} // namespace spang
@@ -0,0 +1,98 @@
+#pragma once
+
+#include <spang/dfs.hpp>
+#include <spang/graph.hpp>
+#include <spang/preprocess.hpp>
+
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace spang
+{
+
+/*!
+An inverted index from labels to the graphs of a database that have them, so that graphs which
+cannot contain a pattern are ruled out before any embedding of it is looked for. Maps each vertex
+label, and each (vertex label, edge label, vertex label) triple of an edge, to the graphs with one,
+and keeps the number of vertices with each label in each graph.
+
+Built from a preprocessed database, so only the labels left after pruning are indexed. Graphs are
+referred to by their index in the database, not their input ID. Posting lists are stored as varints
+of the gaps between increasing indexes, less one, as support lists are in the binary output format.
+*/
+class label_index
+{
+  public:
+	template <class local_id_t>
+	explicit label_index(std::span<const basic_compact_graph_t<local_id_t>> graphs);
+
+	//! Indexes a database of whichever ID width it was preprocessed with.
+	explicit label_index(const any_graph_database& graphs);
+
+	[[nodiscard]] std::size_t n_graphs() const { return count_starts.size() - 1; }
+
+	//! The number of vertices with the label, over all graphs.
+	[[nodiscard]] std::size_t vertex_label_count(vertex_label_t label) const;
+
+	//! The number of vertices with the label in the graph at the given index.
+	[[nodiscard]] std::size_t vertex_label_count(std::size_t graph, vertex_label_t label) const;
+
+	//! The indexes of the graphs with a vertex with the label, in increasing order.
+	[[nodiscard]] std::vector<std::size_t> graphs_with_vertex_label(vertex_label_t label) const;
+
+	//! The indexes of the graphs with an edge with the labels, either way round, in increasing
+	//! order.
+	[[nodiscard]] std::vector<std::size_t> graphs_with_edge(vertex_label_t from_label,
+	                                                        edge_label_t edge_label,
+	                                                        vertex_label_t to_label) const;
+
+	/*!
+	The indexes of the graphs that could contain the pattern given by codes, in increasing order:
+	those with an edge for each of its label triples, found by intersecting their posting lists,
+	shortest first, and with at least as many vertices of each label as it has.
+	*/
+	[[nodiscard]] std::vector<std::size_t> candidates(std::span<const dfs_edge_t> codes) const;
+
+  private:
+	struct posting_list
+	{
+		std::vector<std::uint8_t> gaps;
+		std::size_t size = 0;
+		//! The last index added.
+		std::size_t last = 0;
+
+		void add(std::size_t graph);
+		[[nodiscard]] std::vector<std::size_t> decode() const;
+	};
+
+	//! An edge's labels, with the lesser vertex label first.
+	struct edge_key
+	{
+		vertex_label_t from_label;
+		edge_label_t edge_label;
+		vertex_label_t to_label;
+
+		edge_key(vertex_label_t from, edge_label_t edge, vertex_label_t to);
+
+		[[nodiscard]] bool operator==(const edge_key&) const = default;
+	};
+
+	struct edge_key_hash
+	{
+		std::size_t operator()(const edge_key& key) const;
+	};
+
+	std::unordered_map<vertex_label_t, posting_list> vertex_postings;
+	std::unordered_map<edge_key, posting_list, edge_key_hash> edge_postings;
+	std::unordered_map<vertex_label_t, std::size_t> vertex_totals;
+
+	// Per graph, the (label, count) of each of its vertex labels, in increasing order of label.
+	std::vector<std::size_t> count_starts{0};
+	std::vector<std::pair<vertex_label_t, std::size_t>> label_counts;
+};
+
+} // namespace spang
@@ -0,0 +1,44 @@
+#pragma once
+
+#include <spang/dfs.hpp>
+#include <spang/graph.hpp>
+#include <spang/preprocess.hpp>
+
+#include <cstddef>
+#include <span>
+#include <vector>
+
+namespace spang
+{
+
+/*!
+Finds which graphs each of a list of patterns occurs in, such as to count the support of patterns
+mined from one database in another. Patterns are given as DFS codes, whose vertices may be
+numbered in any order the code's edges reach them, as canonical_code() gives for a pattern read
+from an output file. Each must be connected and have at least one edge.
+
+Only the graphs a label_index gives as candidates for a pattern, having all of its labels, are
+searched. Each pattern's vertices are matched in an order chosen up front: starting from a vertex
+with the rarest label in the graphs, then always the one with the most edges to vertices already
+matched, so that a partial match fails as early as it can. Graph vertices are only tried for a
+pattern vertex if they have its label and at least its degree, and are found through the (edge
+label, neighbour label) order of the adjacency lists. Matching a pattern in a graph stops at its
+first embedding.
+
+Patterns are shared out between n_threads threads, each finding a pattern's candidates only when it
+starts on it, so that only the lists for the patterns being matched are held. Returns the input IDs
+of the graphs each pattern occurs in, in database order.
+*/
+template <class local_id_t>
+[[nodiscard]] auto match_patterns(const std::span<const basic_compact_graph_t<local_id_t>> graphs,
+                                  const std::span<const std::vector<dfs_edge_t>> patterns,
+                                  const std::size_t n_threads = 1)
+	-> std::vector<std::vector<graph_id_t>>;
+
+//! As above, for a database of whichever ID width it was preprocessed with.
+[[nodiscard]] auto match_patterns(const any_graph_database& graphs,
+                                  const std::span<const std::vector<dfs_edge_t>> patterns,
+                                  const std::size_t n_threads = 1)
+	-> std::vector<std::vector<graph_id_t>>;
+
+} // namespace spang
@@ -0,0 +1,54 @@
+#pragma once
+
+#include <spang/constraints.hpp>
+#include <spang/preprocess.hpp>
+#include <spang/report.hpp>
+#include <spang/support.hpp>
+
+#include <cstddef>
+#include <span>
+
+namespace spang
+{
+
+/*!
+Mines every subgraph with a support of at least min_freq in the given (preprocessed) graphs,
+reporting each one as it is found. Support is the number of graphs a subgraph occurs in by default.
+
+For minimum image based support, such as when mining a single large graph, preprocess with a
+min_freq of 1, as preprocessing prunes by the number of graphs.
+
+Each pattern is reported to sink with the detail given by level; lists of graph IDs are only built
+if they are reported.
+
+Only patterns meeting the constraints are reported, and the search stops growing patterns once they
+break an anti-monotone one. The graphs should have been preprocessed with the same constraints.
+
+The search is run over n_threads threads. Subtrees are started heaviest first, and subtrees that
+are still large compared to the rest of the search are split off into separate tasks.
+*/
+template <class local_id_t>
+void mine(const std::span<const basic_compact_graph_t<local_id_t>> graphs,
+          const std::size_t min_freq, const std::size_t n_threads = 1,
+          const support_measure measure = support_measure::graphs,
+          const report_level level = report_level::support,
+          const constraints_t& constraints = {}, report_sink& sink = default_report_sink());
+
+template <class local_id_t>
+void mine(const basic_graph_database<local_id_t>& graphs, const std::size_t min_freq,
+          const std::size_t n_threads = 1, const support_measure measure = support_measure::graphs,
+          const report_level level = report_level::support, const constraints_t& constraints = {},
+          report_sink& sink = default_report_sink())
+{
+	mine(std::span<const basic_compact_graph_t<local_id_t>>{graphs}, min_freq, n_threads,
+	     measure, level, constraints, sink);
+}
+
+//! Mines a database of whichever ID width it was preprocessed with.
+void mine(const any_graph_database& graphs, const std::size_t min_freq,
+          const std::size_t n_threads = 1,
+          const support_measure measure = support_measure::graphs,
+          const report_level level = report_level::support,
+          const constraints_t& constraints = {}, report_sink& sink = default_report_sink());
+
+} // namespace spang
@@ -2,16 +2,25 @@
 
 #include <spang/graph.hpp>
 
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <functional>
 #include <iostream>
 #include <set>
+#include <span>
+#include <string_view>
 #include <vector>
 
 namespace spang
 {
 
+//! Vertex IDs as read from a file, wide enough for any graph that can be mined.
+using parsed_vertex_id_t = std::uint32_t;
+
 struct parsed_edge_t
 {
-	vertex_id_t from, to;
+	parsed_vertex_id_t from, to;
 	edge_label_t label;
 
 	bool operator==(const parsed_edge_t&) const = default;
@@ -20,7 +29,7 @@ struct parsed_edge_t
 
 struct parsed_vertex_t
 {
-	vertex_id_t id;
+	parsed_vertex_id_t id;
 	vertex_label_t label;
 
 	bool operator==(const parsed_vertex_t&) const = default;
@@ -40,6 +49,8 @@ struct parsed_output_graph_base_t
 {
 	std::vector<parsed_vertex_t> vertices;
 	std::vector<parsed_edge_t> edges;
+	//! The support as given, and the IDs of the graphs the pattern is in, if they were given.
+	std::size_t support_count;
 	std::vector<graph_id_t> support;
 
 	bool operator==(const parsed_output_graph_base_t&) const = default;
@@ -51,6 +62,13 @@ struct parsed_output_graph_t : parsed_output_graph_base_t
 	graph_id_t id;
 };
 
+/*!
+Parses graphs from a stream in the input format, passing each to on_graph as soon as it has been
+read, so that only one graph is held in memory at a time.
+*/
+void read_input_graphs(std::istream& stream,
+                       const std::function<void(parsed_input_graph_t&&)>& on_graph);
+
 /*!
 Class for parsing input files.
 */
@@ -65,6 +83,24 @@ class input_parser
 	std::vector<parsed_input_graph_t> graphs;
 };
 
+/*!
+Parses graphs from a stream in the output format, passing each to on_graph as soon as it has been
+read, so that only one graph is held in memory at a time.
+*/
+void read_output_graphs(std::istream& stream,
+                        const std::function<void(parsed_output_graph_t&&)>& on_graph);
+
+//! As above, but parses text already in memory, in place.
+void read_output_graphs(std::string_view text,
+                        const std::function<void(parsed_output_graph_t&&)>& on_graph);
+
+/*!
+As above, but for a whole file, which is mapped into memory rather than read through a stream
+where the platform allows.
+*/
+void read_output_file(const std::filesystem::path& path,
+                      const std::function<void(parsed_output_graph_t&&)>& on_graph);
+
 /*!
 Class for re-parsing output files. Intended to be used
 to compare output files of different implementations
@@ -75,6 +111,9 @@ class output_parser
   public:
 	void read(std::istream& stream);
 
+	//! Reads each of the files, spread over up to n_threads threads.
+	void read(std::span<const std::filesystem::path> files, std::size_t n_threads);
+
 	const auto& get_graphs() const { return graphs; }
 
   private:
@@ -1,10 +1,15 @@
 #pragma once
 
+#include <spang/constraints.hpp>
 #include <spang/graph.hpp>
 #include <spang/parser.hpp>
+#include <spang/utility.hpp>
 
-#include <memory>
+#include <cstdint>
+#include <istream>
+#include <ranges>
 #include <span>
+#include <variant>
 #include <vector>
 
 namespace spang
@@ -13,43 +18,244 @@ namespace spang
 /*!
 Compact graph representation. Micro-optimization to
 avoid cache misses while observing a single graph.
+
+Stored in compressed sparse row (CSR) format, as a structure of arrays: the adjacency list of
+vertex v is the range [offsets[v], offsets[v + 1]) of each of the per-adjacency arrays. Each
+undirected edge appears once in the adjacency list of each of its endpoints. The label of each
+neighbour is stored alongside, so that filtering candidates by label is a sequential scan rather
+than a lookup per neighbour.
+
+Each adjacency list is sorted by edge label, then by neighbour label.
+
+Vertex and edge IDs are stored as local_id_t, see basic_edge_t.
+
+The arrays are views into a graph database, which owns them, so these are cheap to copy, but only
+valid while the database is.
 */
-struct compact_graph_t
+template <class local_id_t>
+struct basic_compact_graph_t
 {
-	struct compact_vertex_t
-	{
-		vertex_label_t label;
-		vertex_id_t id;
-		std::span<edge_t> edges;
-	};
+	//! Index into the per-adjacency arrays.
+	using adjacency_index_t = std::uint32_t;
 
 	graph_id_t id;
+	//! One more than the largest edge ID. Edge IDs are kept from the input graph, so after pruning
+	//! some IDs below this may be unused.
 	std::uint32_t n_edges = 0;
-	std::vector<compact_vertex_t> vertices;
-
-	//! Compacts a given graph into adjacency list format, given a list of edges.
-	//! (The edges in the input graph are ignored.)
-	//! Prunes infrequent edges, then removes vertices with no edges.
-	//! Relabels vertex indexes in edges as needed.
-	//! Assumes at least 1 edge.
-	//! vertex_id_to_n_edges and vertex_id_map are used as scratch memory.
-	compact_graph_t(const parsed_input_graph_t& input, const std::span<const edge_t> edges,
-	                std::vector<vertex_id_t>& vertex_id_to_n_edges,
-	                std::vector<vertex_id_t>& vertex_id_map);
+
+	// Per vertex
+	std::span<const vertex_label_t> vertex_labels;
+	//! Has one more entry than there are vertices, the last being the total adjacency count.
+	std::span<const adjacency_index_t> offsets;
+
+	// Per adjacency
+	std::span<const local_id_t> neighbours;
+	std::span<const vertex_label_t> neighbour_labels;
+	std::span<const edge_label_t> edge_labels;
+	std::span<const local_id_t> edge_ids;
+
+	[[nodiscard]] std::size_t n_vertices() const { return offsets.size() - 1; }
+
+	//! Indexes of the adjacency list of a vertex.
+	[[nodiscard]] auto adjacency(const local_id_t vertex) const
+	{
+		return std::views::iota(offsets[vertex], offsets[vertex + 1]);
+	}
+
+	//! Returns the first index in [first, last), a sorted part of an adjacency list, whose
+	//! (edge label, neighbour label) is not less than the given labels, or last if there is none.
+	[[nodiscard]] adjacency_index_t lower_bound(adjacency_index_t first,
+	                                            const adjacency_index_t last,
+	                                            const edge_label_t edge_label,
+	                                            const vertex_label_t neighbour_label) const
+	{
+		auto count = last - first;
+		while (count > 0)
+		{
+			const auto step = count / 2;
+			const auto middle = first + step;
+			if (lexicographic_less(edge_labels[middle], edge_label, neighbour_labels[middle],
+			                       neighbour_label))
+			{
+				first = middle + 1;
+				count -= step + 1;
+			}
+			else
+			{
+				count = step;
+			}
+		}
+		return first;
+	}
+
+	//! Reassembles an edge from the adjacency list of its from vertex.
+	[[nodiscard]] basic_edge_t<local_id_t> edge(const local_id_t from,
+	                                            const adjacency_index_t index) const
+	{
+		return basic_edge_t<local_id_t>{.from = from,
+		              .to = neighbours[index],
+		              .label = edge_labels[index],
+		              .id = edge_ids[index]};
+	}
+
+	//! The adjacency list of a vertex, as edges. Prefer iterating over adjacency() and reading
+	//! only the arrays needed in hot loops.
+	[[nodiscard]] auto edges(const local_id_t vertex) const
+	{
+		return adjacency(vertex) |
+		       std::views::transform([this, vertex](const adjacency_index_t index)
+		                             { return edge(vertex, index); });
+	}
+};
+
+using compact_graph_t = basic_compact_graph_t<vertex_id_t>;
+
+/*!
+Owns the arrays of a set of compact graphs. Rather than each graph having arrays of its own, the
+graphs are stored back to back in blocks of consecutive graphs, so that there are only a few large
+allocations, consecutive graphs are close together in memory, and teardown is nearly free.
+
+Can be used wherever a span of compact graphs is expected. A block's arrays never move once it is
+added, so the graphs stay valid when the database is moved, but it cannot be copied.
+*/
+template <class local_id_t>
+class basic_graph_database
+{
+  public:
+	using graph_type = basic_compact_graph_t<local_id_t>;
+	using edge_type = basic_edge_t<local_id_t>;
+	using adjacency_index_t = typename graph_type::adjacency_index_t;
+
+	//! Scratch memory for add_graph, which can be reused between graphs and blocks.
+	struct scratch
+	{
+		std::vector<local_id_t> vertex_id_to_n_edges;
+		std::vector<local_id_t> vertex_id_map;
+		std::vector<edge_type> adjacency;
+	};
+
+	/*!
+	The arrays of a run of consecutive graphs, back to back.
+	*/
+	class block
+	{
+	  public:
+		//! Compacts a given graph into adjacency list format, given a list of edges, and adds it
+		//! to the end of the block. (The edges in the input graph are ignored.)
+		//! Removes vertices with no edges, relabelling vertex indexes in edges as needed.
+		//! Assumes at least 1 edge, and that the input graph's IDs fit in local_id_t.
+		void add_graph(const parsed_input_graph_t& input, const std::span<const edge_type> edges,
+		               scratch& scratch_memory);
+
+		[[nodiscard]] std::size_t size() const { return ids.size(); }
+
+		//! Releases any spare capacity, once no more graphs will be added.
+		void shrink_to_fit();
+
+	  private:
+		friend basic_graph_database;
+
+		// Per graph
+		std::vector<graph_id_t> ids;
+		std::vector<std::uint32_t> n_edges;
+		//! Where each graph starts in the per vertex and per adjacency arrays, plus the end of the
+		//! last graph. A graph's offsets start at its vertex start plus its index, as each graph
+		//! has one more offset than vertices.
+		std::vector<std::size_t> vertex_starts{0};
+		std::vector<std::size_t> adjacency_starts{0};
+
+		// Per vertex
+		std::vector<vertex_label_t> vertex_labels;
+		//! Relative to the start of the graph's adjacency.
+		std::vector<adjacency_index_t> offsets;
+
+		// Per adjacency
+		std::vector<local_id_t> neighbours;
+		std::vector<vertex_label_t> neighbour_labels;
+		std::vector<edge_label_t> edge_labels;
+		std::vector<local_id_t> edge_ids;
+	};
+
+	basic_graph_database() = default;
+	basic_graph_database(const basic_graph_database&) = delete;
+	basic_graph_database(basic_graph_database&&) = default;
+	basic_graph_database& operator=(const basic_graph_database&) = delete;
+	basic_graph_database& operator=(basic_graph_database&&) = default;
+	~basic_graph_database() = default;
+
+	//! Adds the graphs in a block to the end of the database.
+	void append(block&& new_block);
+
+	[[nodiscard]] std::size_t size() const { return graphs.size(); }
+	[[nodiscard]] bool empty() const { return graphs.empty(); }
+	[[nodiscard]] const graph_type& operator[](const std::size_t index) const
+	{
+		return graphs[index];
+	}
+	[[nodiscard]] const graph_type* data() const { return graphs.data(); }
+	[[nodiscard]] const graph_type* begin() const { return graphs.data(); }
+	[[nodiscard]] const graph_type* end() const { return graphs.data() + graphs.size(); }
 
   private:
-	// Contains all edges in a single allocation, vertices reference this via std::spans.
-	std::unique_ptr<edge_t[]> edges;
+	std::vector<block> blocks;
+	std::vector<graph_type> graphs;
 };
 
+using graph_database = basic_graph_database<vertex_id_t>;
+
+/*!
+A graph database with IDs of any of the supported widths. Which one is only known once the input
+has been read, so code that runs on the database is instantiated for each and picked with
+std::visit.
+*/
+using any_graph_database =
+	std::variant<basic_graph_database<std::uint8_t>, basic_graph_database<std::uint16_t>,
+                 basic_graph_database<std::uint32_t>>;
+
 /*!
 Prunes edges and vertices that would not be in any frequent 1-edge graphs and converts
 from a edge list to an adjacency list format.
 
 Will remove data from graphs as it is converted, in order to prevent two full copies
 of the data from residing in memory.
+
+The graphs are converted over up to n_threads threads. The result is in input order either way.
+
+Labels forbidden by the constraints are pruned as infrequent ones are, and graphs left without a
+label the constraints require are dropped.
+
+Every graph must have fewer vertices and fewer edges than the largest local_id_t, which is kept
+free as a sentinel. preprocess_narrowest() picks a width that fits.
 */
-[[nodiscard]] auto preprocess(std::vector<parsed_input_graph_t>&& graphs, std::size_t min_freq)
-	-> std::vector<compact_graph_t>;
+template <class local_id_t = vertex_id_t>
+[[nodiscard]] auto preprocess(std::vector<parsed_input_graph_t>&& graphs, std::size_t min_freq,
+                              std::size_t n_threads = 1, const constraints_t& constraints = {})
+	-> basic_graph_database<local_id_t>;
+
+/*!
+As above, but reads the graphs from a stream in the input format, holding only a few chunks of
+parsed graphs in memory at a time, so that peak memory is the compact database rather than that
+plus the parsed one. Graphs are compacted over n_threads threads while the stream is read. The
+stream is read twice, once to count labels and once to build the graphs. A stream that cannot be
+rewound, such as a pipe, is first copied into memory as text, which is still smaller than the
+parsed graphs.
+*/
+template <class local_id_t = vertex_id_t>
+[[nodiscard]] auto preprocess(std::istream& stream, std::size_t min_freq,
+                              std::size_t n_threads = 1, const constraints_t& constraints = {})
+	-> basic_graph_database<local_id_t>;
+
+/*!
+As preprocess(), but stores IDs in the narrowest width that fits the largest input graph.
+*/
+[[nodiscard]] auto preprocess_narrowest(std::vector<parsed_input_graph_t>&& graphs,
+                                        std::size_t min_freq, std::size_t n_threads = 1,
+                                        const constraints_t& constraints = {})
+	-> any_graph_database;
+
+[[nodiscard]] auto preprocess_narrowest(std::istream& stream, std::size_t min_freq,
+                                        std::size_t n_threads = 1,
+                                        const constraints_t& constraints = {})
+	-> any_graph_database;
 
 } // namespace spang
@@ -1,11 +1,15 @@
 #pragma once
 
+#include <spang/dfs.hpp>
 #include <spang/graph.hpp>
 #include <spang/preprocess.hpp>
 
+#include <concepts>
+#include <cstdint>
 #include <limits>
 #include <memory>
 #include <span>
+#include <vector>
 
 namespace spang
 {
@@ -16,20 +20,26 @@ one edge in this instance. This eventually develops into a tree structure, where
 links may extend out of an existing one, hence the lack of a standard container such as
 std::list or std::vector.
 */
-struct dfs_projection_link
+template <class local_id_t>
+struct basic_dfs_projection_link
 {
-	//! ID of the graph this link is in (not particularly memory efficient, as prev_link will
-	//! point to a link with the same ID, but leads to a simpler implementation).
+	//! Index of the graph this link is in, within the graph database being mined. This is not the
+	//! ID from the input, since graphs may be removed during preprocessing. (Not particularly
+	//! memory efficient, as prev_link will point to a link with the same index, but leads to a
+	//! simpler implementation).
 	graph_id_t graph_id;
 
-	//! The actual edge in the graph that this link represents.
-	const edge_t& edge;
+	//! The actual edge in the graph that this link represents. Held by value, as compact graphs
+	//! do not store edges as objects that could be referred to.
+	basic_edge_t<local_id_t> edge;
 
 	//! A non-owning pointer to the previous link in the chain, or nullptr if this is
 	//! the first link.
-	const dfs_projection_link* prev_link;
+	const basic_dfs_projection_link* prev_link;
 };
 
+using dfs_projection_link = basic_dfs_projection_link<vertex_id_t>;
+
 /*!
 A 'min projection' is an instance of a DFS code in its own graph
 representation. This (also) eventually develops into a tree structure.
@@ -52,67 +62,148 @@ struct min_dfs_projection_link
 /*!
 A 'projection view' encodes a (min) projection in a way that information about it is
 accessible in constant time, rather than having to iterate over the tree structure each time.
+
+Graph vertices and edges are indexed by local_id_t, while the DFS vertices they map to are always
+vertex_id_t. Min projections are in min graphs, whose IDs are vertex_id_t, so only views with
+those IDs can build min views.
 */
-class projection_view
+template <class local_id_t>
+class basic_projection_view
 {
   public:
-	projection_view(std::size_t max_edges, std::size_t max_vertices);
+	/*!
+	Creates a view able to hold projections of up to max_edges edges, in graphs of up to max_edges
+	edges and max_vertices vertices. Views of dfs_projections grow as needed to fit larger graphs.
+	*/
+	basic_projection_view(std::size_t max_edges, std::size_t max_vertices);
+
+	/*!
+	Starts viewing projections in a new graph, growing the view to fit it if needed.
+	*/
+	void start_graph(const basic_compact_graph_t<local_id_t>& graph);
 
 	/*!
-	Builds a view of a dfs_projection.
+	Builds a view of a dfs_projection, which is an instance of dfs_code_list in the graph given to
+	the last call to start_graph. Consecutive projections in the same graph share the work for
+	any links they have in common.
 	*/
-	void build_view(const dfs_projection_link& start, const compact_graph_t& graph);
+	void build_view(const basic_dfs_projection_link<local_id_t>& start,
+	                const std::span<const dfs_edge_t> dfs_code_list);
 
 	/*!
-	Builds a view of a min_dfs_projection. Does not set information on
-	whether the graph has a vertex or not.
+	Builds a view of a min_dfs_projection, which is an instance of dfs_code_list. Does not set
+	information on whether the graph has a vertex or not.
 	*/
 	void build_min_view_no_has_vertex_info(
-		const graph_t& min_graph, const std::span<const min_dfs_projection_link> projections,
-		const std::size_t projection_start_index);
+		const std::span<const min_dfs_projection_link> projections,
+		const std::size_t projection_start_index, const std::span<const dfs_edge_t> dfs_code_list)
+		requires std::same_as<local_id_t, vertex_id_t>;
 
 	/*!
-	Builds a view of a min_dfs_projection. Does not set information on
-	whether the graph has an edge or not.
+	Builds a view of a min_dfs_projection, which is an instance of dfs_code_list. Does not set
+	information on whether the graph has an edge or not.
 	*/
-	void build_min_view_no_has_edge_info(const graph_t& min_graph,
-	                                     const std::span<const min_dfs_projection_link> projections,
-	                                     const std::size_t projection_start_index);
+	void build_min_view_no_has_edge_info(const std::span<const min_dfs_projection_link> projections,
+	                                     const std::size_t projection_start_index,
+	                                     const std::span<const dfs_edge_t> dfs_code_list)
+		requires std::same_as<local_id_t, vertex_id_t>;
 
-	bool has_edge(const edge_id_t id) const { return has_edge_[id]; }
-	bool has_vertex(const vertex_id_t id) const { return vertex_refcounts[id] != 0; }
+	bool has_edge(const local_id_t id) const
+	{
+		return ((edge_bits[id / bits_per_word] >> (id % bits_per_word)) & 1) != 0;
+	}
+	bool has_vertex(const local_id_t id) const { return vertex_refcounts[id] != 0; }
+
+	//! Gets the DFS vertex a graph vertex is mapped to, or no_vertex if it is not in the view.
+	vertex_id_t dfs_vertex(const local_id_t id) const { return dfs_vertices[id]; }
+
+	constexpr static vertex_id_t no_vertex = std::numeric_limits<vertex_id_t>::max();
 
 	//! Gets the nth edge added to the graph.
 	//! Indexes correspond to the corresponding DFS code list, so get_edge(i) is
 	//! the 'actual' edge in the min graph, while dfs_code_list[i] is the DFS edge.
-	const edge_t& get_edge(const edge_id_t id) const
+	const basic_edge_t<local_id_t>& get_edge(const edge_id_t id) const
 	{
 		const auto index = n_contained_edges - id - 1;
 		return *contained_edges[index];
 	}
 
   private:
-	std::unique_ptr<bool[]> has_edge_;
+	constexpr static std::size_t bits_per_word = 64;
+
+	void set_edge(const local_id_t id)
+	{
+		edge_bits[id / bits_per_word] |= std::uint64_t{1} << (id % bits_per_word);
+	}
+	void toggle_edge(const local_id_t id)
+	{
+		edge_bits[id / bits_per_word] ^= std::uint64_t{1} << (id % bits_per_word);
+	}
+
+	//! Resets everything set for the contained edges. Only they set anything, so this costs
+	//! O(pattern size) regardless of the size of the graph.
+	void clear();
+
+	//! One bit per edge ID.
+	std::unique_ptr<std::uint64_t[]> edge_bits;
 	// For non-min views, we use refcounts for the optimized algorithm. We cannot use booleans with
 	// toggles, since any vertex that is referenced twice would count as unreferenced. We could
 	// potentially use that approach if we could distinguish forwards edges, but I don't know if
 	// that's possible with the information given. This is effectively a boolean for min views,
 	// Maybe another reason to split this class in two, though we may also want to try that approach
 	// for those.
-	std::unique_ptr<vertex_id_t[]> vertex_refcounts;
-	std::unique_ptr<const edge_t*[]> contained_edges;
+	std::unique_ptr<local_id_t[]> vertex_refcounts;
+	// Always set, for both kinds of views. Vertices are unmapped as they leave the view, so this
+	// can be read without checking has_vertex() first.
+	std::unique_ptr<vertex_id_t[]> dfs_vertices;
+	std::unique_ptr<const basic_edge_t<local_id_t>*[]> contained_edges;
 	std::size_t n_contained_edges{0};
+	std::size_t edge_capacity;
+	std::size_t vertex_capacity;
 
-	// Only used for non-min views
+	// Only used for non-min views, nullptr if there is no projection from the current graph yet.
 	// Todo: Should min projection view be a separate class? Current implementation doesn't require
 	// vertex refcounts (just bools), but it may be updated to use the more optimal algorithm.
-	const compact_graph_t* contained_graph{nullptr};
-	const dfs_projection_link* contained_link{nullptr};
+	const basic_dfs_projection_link<local_id_t>* contained_link{nullptr};
 
 	template <bool include_edge_info, bool include_vertex_info>
-	void build_min_view(const graph_t& min_graph,
-	                    const std::span<const min_dfs_projection_link> projections,
-	                    const std::size_t projection_start_index);
+	void build_min_view(const std::span<const min_dfs_projection_link> projections,
+	                    const std::size_t projection_start_index,
+	                    const std::span<const dfs_edge_t> dfs_code_list)
+		requires std::same_as<local_id_t, vertex_id_t>;
+};
+
+using projection_view = basic_projection_view<vertex_id_t>;
+
+/*!
+A backwards edge from the rightmost vertex can only close a cycle with a vertex on the rightmost
+path, and is compared against the rightmost path edge leaving that vertex. This finds that edge in
+constant time, rather than searching the rightmost path for each candidate edge.
+*/
+class rightmost_path_lookup
+{
+  public:
+	rightmost_path_lookup(const std::span<const dfs_edge_t> dfs_code_list,
+	                      const std::span<const edge_id_t> rightmost_path);
+
+	/*!
+	Returns the index (in the DFS code list) of the rightmost path edge leaving the vertex a
+	backwards edge to graph_vertex would reach, or no_edge if there is none. Works with any view
+	that can map graph vertices to DFS vertices. The rightmost
+	vertex and its parent never have one, as they are already connected to the rightmost vertex.
+	*/
+	template <class view_t, class local_id_t>
+	edge_id_t backwards_target(const view_t& view, const local_id_t graph_vertex) const
+	{
+		const auto dfs_vertex = view.dfs_vertex(graph_vertex);
+		return dfs_vertex < rmp_edges.size() ? rmp_edges[dfs_vertex] : no_edge;
+	}
+
+	constexpr static edge_id_t no_edge = std::numeric_limits<edge_id_t>::max();
+
+  private:
+	//! The rightmost path edge leaving each DFS vertex, if any.
+	std::vector<edge_id_t> rmp_edges;
 };
 
 } // namespace spang
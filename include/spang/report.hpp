@@ -1,17 +1,108 @@
 #pragma once
 
+#include <spang/binary_output.hpp>
 #include <spang/dfs.hpp>
+#include <spang/embedding.hpp>
+#include <spang/graph.hpp>
+#include <spang/preprocess.hpp>
 #include <spang/projection.hpp>
 
+#include <cstddef>
+#include <iostream>
+#include <mutex>
+#include <optional>
 #include <span>
+#include <string_view>
 
 namespace spang
 {
 
-//! Report the given code sequence as frequent. Projections and support are provided as extra info.
-// Todo: Parent graph? Previous thread? (for multithreading)
-void report(const std::span<const dfs_edge_t> codes,
-            const std::span<const dfs_projection_link> projections,
-            const std::size_t codes_support);
+//! How much is reported about each frequent pattern.
+enum class report_level
+{
+	//! Nothing, such as when timing the search alone.
+	none,
+	//! Each pattern and its support.
+	support,
+	//! Each pattern, its support, and the IDs of the graphs it occurs in. Only this level builds
+	//! the list, which takes time proportional to the number of projections.
+	graph_ids,
+};
+
+//! Parses "none", "support" or "graph_ids".
+[[nodiscard]] std::optional<report_level> parse_report_level(std::string_view name);
+
+//! The formats patterns can be written in.
+enum class output_format
+{
+	text,
+	binary,
+};
+
+//! Parses "text" or "binary".
+[[nodiscard]] std::optional<output_format> parse_output_format(std::string_view name);
+
+/*!
+Where reported patterns are written: a stream, in the text or binary output format. Patterns are
+numbered in the order they are written. Patterns may be written from several threads at once, and
+each one's output is kept together.
+
+The binary format is written a block at a time, so the last block is only written on flush() or
+destruction.
+*/
+class report_sink
+{
+  public:
+	explicit report_sink(std::ostream& out, output_format format = output_format::text);
+
+	//! Writes a pattern. graph_ids must be in increasing order, and may be left empty.
+	void write(std::span<const dfs_edge_t> codes, std::size_t support,
+	           std::span<const graph_id_t> graph_ids);
+
+	//! Writes out any patterns still held back.
+	void flush();
+
+  private:
+	std::mutex mutex;
+	std::ostream& out_;
+	//! Only used for the binary format.
+	std::optional<binary_pattern_writer> binary;
+	//! Guarded by mutex.
+	graph_id_t next_pattern_id{0};
+};
+
+//! The sink patterns are reported to unless another is given: text written to std::cout.
+[[nodiscard]] report_sink& default_report_sink();
+
+//! Report the given code sequence as frequent to sink, with as much detail as level asks for.
+//! Projections and support are provided as extra info.
+//! May be called from several threads at once.
+// Todo: Parent graph?
+template <class local_id_t>
+void report(const std::span<const basic_compact_graph_t<local_id_t>> graphs,
+            const std::span<const dfs_edge_t> codes,
+            const std::span<const basic_dfs_projection_link<local_id_t>> projections,
+            const std::size_t codes_support, const report_level level,
+            report_sink& sink = default_report_sink());
+
+//! As above, with the instances of the pattern given as an embedding list.
+template <class local_id_t>
+void report(const std::span<const basic_compact_graph_t<local_id_t>> graphs,
+            const std::span<const dfs_edge_t> codes,
+            const basic_embedding_list<local_id_t>& embeddings, const std::size_t codes_support,
+            const report_level level, report_sink& sink = default_report_sink());
+
+//! As above, for a pattern whose graph IDs are already known, in increasing order. They are only
+//! written at the graph_ids level.
+void report(std::span<const dfs_edge_t> codes, std::size_t codes_support,
+            std::span<const graph_id_t> graph_ids, report_level level,
+            report_sink& sink = default_report_sink());
+
+/*!
+Writes a pattern in the text output format, with its vertices numbered in DFS order. No list of
+graph IDs is written if graph_ids is empty.
+*/
+void write_text_pattern(std::ostream& out, graph_id_t id, std::span<const dfs_edge_t> codes,
+                        std::size_t support, std::span<const graph_id_t> graph_ids);
 
 } // namespace spang
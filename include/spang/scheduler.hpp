@@ -0,0 +1,73 @@
+#pragma once
+
+#include <condition_variable>
+#include <cstddef>
+#include <functional>
+#include <mutex>
+#include <queue>
+#include <vector>
+
+namespace spang
+{
+
+/*!
+A pool of worker threads that runs tasks in order of decreasing estimated cost, so that the
+largest pieces of work are started first and do not end up running alone at the end. Tasks may
+submit further tasks while running; run() returns once every task has finished.
+*/
+class task_scheduler
+{
+  public:
+	using task = std::function<void()>;
+
+	//! A scheduler with a single thread runs every task on the thread calling run().
+	explicit task_scheduler(std::size_t n_threads);
+
+	//! Queues a task. Tasks of equal cost run in submission order.
+	void submit(std::size_t cost, task work);
+
+	//! Runs queued tasks (and any they submit) until none remain. May be called again after.
+	void run();
+
+	[[nodiscard]] std::size_t n_threads() const { return n_threads_; }
+
+	//! The number of threads that have nothing to do, not counting those about to pick up a queued
+	//! task. A task may share its own work out between them with run_parts().
+	[[nodiscard]] std::size_t n_idle_threads();
+
+	/*!
+	Calls work(part) for each part in [0, n_parts), and returns once they have all finished. Meant
+	to be called from a running task: parts are queued ahead of every other task for idle threads
+	to take, and the calling thread runs any that no other thread has started, so no threads are
+	added to the pool and the call never waits on a queued task.
+	*/
+	void run_parts(std::size_t n_parts, const std::function<void(std::size_t)>& work);
+
+  private:
+	struct queued_task
+	{
+		std::size_t cost;
+		std::size_t sequence;
+		task work;
+
+		// std::priority_queue is a max heap, so the "largest" task is the costliest, oldest one.
+		[[nodiscard]] bool operator<(const queued_task& other) const
+		{
+			return cost != other.cost ? cost < other.cost : sequence > other.sequence;
+		}
+	};
+
+	void run_worker();
+
+	std::size_t n_threads_;
+
+	std::mutex mutex;
+	std::condition_variable task_available;
+	std::priority_queue<queued_task> queue;
+	std::size_t n_submitted{0};
+	//! Number of workers currently running a task. Once this is 0 with an empty queue, no more
+	//! tasks can appear.
+	std::size_t n_busy{0};
+};
+
+} // namespace spang
@@ -0,0 +1,85 @@
+#pragma once
+
+#include <spang/constraints.hpp>
+#include <spang/dfs.hpp>
+#include <spang/embedding.hpp>
+#include <spang/label_index.hpp>
+#include <spang/parser.hpp>
+#include <spang/preprocess.hpp>
+#include <spang/report.hpp>
+
+#include <cstddef>
+#include <span>
+#include <vector>
+
+namespace spang
+{
+
+/*!
+Finds every embedding of the pattern given by a DFS code in the graphs. The code's edges are
+matched in order, each forwards edge to a new graph vertex and each backwards edge to an edge
+between vertices already matched, so codes must number the pattern's vertices in the order its
+edges reach them, as any DFS code does.
+
+Embeddings are grouped by graph, in database order. If an index of the graphs is given, only the
+graphs it gives as candidates for the pattern are searched.
+*/
+template <class local_id_t>
+[[nodiscard]] auto find_embeddings(const std::span<const basic_compact_graph_t<local_id_t>> graphs,
+                                   const std::span<const dfs_edge_t> codes,
+                                   const label_index* index = nullptr)
+	-> basic_embedding_list<local_id_t>;
+
+/*!
+Whether the pattern given by a DFS code occurs in a graph, with codes as for find_embeddings().
+Stops at the first embedding found, so is much cheaper than finding them all when there are many.
+*/
+template <class local_id_t>
+[[nodiscard]] bool has_embedding(const basic_compact_graph_t<local_id_t>& graph,
+                                 std::span<const dfs_edge_t> codes);
+
+/*!
+The minimal DFS code of a seed pattern given in the input format, such as one read by
+read_input_graphs(). Logs an error if the seed is not connected or has no edges.
+*/
+[[nodiscard]] auto seed_code(const parsed_input_graph_t& seed) -> std::vector<dfs_edge_t>;
+
+/*!
+Mines every subgraph with a support of at least min_freq in the given graphs that contains the seed
+pattern, reporting each one once, as it is found. Support is the number of graphs a subgraph occurs
+in.
+
+Rather than starting from every frequent edge, the search starts from the embeddings of the seed
+and grows them an edge at a time, so its cost depends on the part of the database around the seed.
+Patterns are grown at any vertex, not only on the rightmost path, as many patterns containing the
+seed have no DFS code starting with one of the seed's. Patterns reached more than once are told
+apart by their minimal DFS codes. Runs on a single thread.
+
+Constraints and report levels are as for mine(). An index of the graphs, if given, limits the
+search for the seed to the graphs that have all of its labels, which is worth building once when
+mining from several seeds.
+*/
+template <class local_id_t>
+void mine_seeded(const std::span<const basic_compact_graph_t<local_id_t>> graphs,
+                 const parsed_input_graph_t& seed, const std::size_t min_freq,
+                 const report_level level = report_level::support,
+                 const constraints_t& constraints = {}, const label_index* index = nullptr,
+                 report_sink& sink = default_report_sink());
+
+template <class local_id_t>
+void mine_seeded(const basic_graph_database<local_id_t>& graphs, const parsed_input_graph_t& seed,
+                 const std::size_t min_freq, const report_level level = report_level::support,
+                 const constraints_t& constraints = {}, const label_index* index = nullptr,
+                 report_sink& sink = default_report_sink())
+{
+	mine_seeded(std::span<const basic_compact_graph_t<local_id_t>>{graphs}, seed, min_freq, level,
+	            constraints, index, sink);
+}
+
+//! Mines a database of whichever ID width it was preprocessed with.
+void mine_seeded(const any_graph_database& graphs, const parsed_input_graph_t& seed,
+                 const std::size_t min_freq, const report_level level = report_level::support,
+                 const constraints_t& constraints = {}, const label_index* index = nullptr,
+                 report_sink& sink = default_report_sink());
+
+} // namespace spang
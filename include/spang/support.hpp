@@ -0,0 +1,87 @@
+#pragma once
+
+#include <spang/dfs.hpp>
+#include <spang/preprocess.hpp>
+#include <spang/projection.hpp>
+
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <span>
+#include <string_view>
+#include <vector>
+
+namespace spang
+{
+
+//! How the support of a pattern is counted.
+enum class support_measure
+{
+	//! The number of graphs the pattern occurs in, as in the transaction setting.
+	graphs,
+
+	//! Minimum image based (MNI) support: over the vertices of the pattern, the fewest distinct
+	//! graph vertices any one of them is mapped to by some embedding. Meant for mining a single
+	//! large graph, where counting graphs says nothing. Vertices in different graphs are
+	//! different images, so several graphs are treated as one disconnected graph.
+	minimum_image,
+};
+
+//! Parses "graphs" or "minimum_image".
+[[nodiscard]] std::optional<support_measure> parse_support_measure(std::string_view name);
+
+/*!
+The number of distinct graphs the given projections are in. Projections are grouped by graph, as
+extension produces them.
+*/
+template <class local_id_t>
+[[nodiscard]] std::size_t
+count_graph_support(const std::span<const basic_dfs_projection_link<local_id_t>> projections)
+{
+	std::size_t support = 0;
+	for (std::size_t i = 0; i < projections.size(); ++i)
+	{
+		support += i == 0 || projections[i].graph_id != projections[i - 1].graph_id;
+	}
+	return support;
+}
+
+/*!
+Counts minimum image based support. Keeps a bitset of images for each pattern vertex, with a bit
+per graph vertex, so can be reused between patterns to avoid reallocating them. Only the bits set
+by a pattern are cleared afterwards, so counting costs O(embeddings * pattern size), regardless of
+the size of the graphs.
+*/
+template <class local_id_t>
+class basic_mni_counter
+{
+  public:
+	/*!
+	The MNI support of the pattern given by dfs_code_list, whose projections are given grouped by
+	graph, as extension produces them.
+	*/
+	[[nodiscard]] std::size_t
+	count(std::span<const basic_compact_graph_t<local_id_t>> graphs,
+	      std::span<const dfs_edge_t> dfs_code_list,
+	      std::span<const basic_dfs_projection_link<local_id_t>> projections);
+
+  private:
+	constexpr static std::size_t bits_per_word = 64;
+
+	//! Calls mark(dfs_vertex, graph_vertex) for each vertex of each of the projections.
+	template <class mark_t>
+	static void for_each_image(std::span<const dfs_edge_t> dfs_code_list,
+	                           std::span<const basic_dfs_projection_link<local_id_t>> projections,
+	                           mark_t mark);
+
+	//! The bitset of pattern vertex v is the words [v * words_per_vertex, (v + 1) *
+	//! words_per_vertex).
+	std::vector<std::uint64_t> images;
+	std::size_t words_per_vertex{0};
+	//! The number of images of each pattern vertex, summed over the graphs counted so far.
+	std::vector<std::size_t> n_images;
+};
+
+using mni_counter = basic_mni_counter<vertex_id_t>;
+
+} // namespace spang
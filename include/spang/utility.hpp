@@ -1,6 +1,12 @@
 #pragma once
 
+#include <algorithm>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
 #include <memory> // IWYU pragma: keep (std::hash)
+#include <optional>
+#include <vector>
 
 namespace spang
 {
@@ -40,4 +46,42 @@ void hash_combine(std::size_t& seed, T value)
 	seed ^= std::hash<T>{}(value) + 0x9e3779b9 + (seed << 6) + (seed >> 2);
 }
 
+//! Appends value as a varint: seven bits to a byte, lowest first, with the top bit set on every
+//! byte but the last.
+inline void write_varint(std::vector<std::uint8_t>& bytes, std::uint64_t value)
+{
+	while (value >= 0x80)
+	{
+		bytes.push_back(static_cast<std::uint8_t>(value | 0x80));
+		value >>= 7;
+	}
+	bytes.push_back(static_cast<std::uint8_t>(value));
+}
+
+//! The number of bytes value takes as a varint.
+[[nodiscard]] constexpr std::size_t varint_size(const std::uint64_t value)
+{
+	return static_cast<std::size_t>(std::max<std::uint64_t>(std::bit_width(value), 1) + 6) / 7;
+}
+
+/*!
+Reads a varint written by write_varint(), taking each byte from next_byte(). Returns std::nullopt
+if it is too long to fit in 64 bits.
+*/
+template <class next_byte_t>
+[[nodiscard]] std::optional<std::uint64_t> decode_varint(next_byte_t&& next_byte)
+{
+	std::uint64_t value = 0;
+	for (int shift = 0; shift < 64; shift += 7)
+	{
+		const std::uint8_t byte = next_byte();
+		value |= static_cast<std::uint64_t>(byte & 0x7f) << shift;
+		if ((byte & 0x80) == 0)
+		{
+			return value;
+		}
+	}
+	return std::nullopt;
+}
+
 } // namespace spang
@@ -0,0 +1,91 @@
+#pragma once
+
+#include <spang/dfs.hpp>
+#include <spang/embedding.hpp>
+#include <spang/extend.hpp>
+#include <spang/is_min.hpp>
+#include <spang/preprocess.hpp>
+#include <spang/projection.hpp>
+#include <spang/support.hpp>
+
+#include <cstddef>
+#include <limits>
+#include <span>
+#include <vector>
+
+namespace spang
+{
+
+//! Which patterns walk_projections() and walk_embeddings() go into.
+struct walk_limits
+{
+	std::size_t min_freq;
+	//! Patterns with this many edges are visited, but not extended.
+	std::size_t max_edges = std::numeric_limits<std::size_t>::max();
+};
+
+/*!
+Walks the search tree below the pattern given by codes, depth first on the calling thread, calling
+visit(codes, projections) on it and on each minimal pattern below it in at least limits.min_freq
+graphs. codes is inout so that it can be added to, and is left as it was given.
+
+This is the search mine() runs, without its scheduling, constraints or reporting, for comparing
+the ways of storing embeddings in tests and benchmarks.
+*/
+template <class local_id_t, class visit_t>
+void walk_projections(const std::span<const basic_compact_graph_t<local_id_t>> graphs,
+                      const walk_limits limits, std::vector<dfs_edge_t>& codes,
+                      const std::span<const basic_dfs_projection_link<local_id_t>> projections,
+                      visit_t&& visit)
+{
+	const auto result = is_min(codes);
+	if (!result)
+	{
+		return;
+	}
+	visit(std::span<const dfs_edge_t>{codes}, projections);
+	if (codes.size() >= limits.max_edges)
+	{
+		return;
+	}
+
+	for (const auto& [code, child] : extend(graphs, codes, projections, result->first))
+	{
+		if (count_graph_support(std::span{child}) >= limits.min_freq)
+		{
+			codes.push_back(code);
+			walk_projections(graphs, limits, codes, std::span{child}, visit);
+			codes.pop_back();
+		}
+	}
+}
+
+//! As walk_projections(), with embeddings stored in embedding lists.
+template <class local_id_t, class visit_t>
+void walk_embeddings(const std::span<const basic_compact_graph_t<local_id_t>> graphs,
+                     const walk_limits limits, std::vector<dfs_edge_t>& codes,
+                     const basic_embedding_list<local_id_t>& embeddings, visit_t&& visit)
+{
+	const auto result = is_min(codes);
+	if (!result)
+	{
+		return;
+	}
+	visit(std::span<const dfs_edge_t>{codes}, embeddings);
+	if (codes.size() >= limits.max_edges)
+	{
+		return;
+	}
+
+	for (const auto& [code, child] : extend_embeddings(graphs, codes, embeddings, result->first))
+	{
+		if (child.support() >= limits.min_freq)
+		{
+			codes.push_back(code);
+			walk_embeddings(graphs, limits, codes, child, visit);
+			codes.pop_back();
+		}
+	}
+}
+
+} // namespace spang
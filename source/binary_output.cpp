@@ -0,0 +1,342 @@
+#include <spang/binary_output.hpp>
+#include <spang/logger.hpp>
+#include <spang/utility.hpp>
+
+#include <algorithm>
+#include <string>
+
+namespace spang
+{
+
+namespace
+{
+
+//! The version written after the magic bytes, increased on any change to the format.
+constexpr std::uint64_t format_version = 1;
+
+//! How a pattern's graph IDs are stored.
+enum class support_encoding : std::uint8_t
+{
+	//! Not stored, only the support is.
+	none = 0,
+	//! The first ID, then the gap to each following one, less one.
+	deltas = 1,
+	//! The first ID, then a bitset over the IDs from it onwards.
+	bitset = 2,
+};
+
+//! Maps signed values to unsigned ones, keeping those near zero small.
+std::uint64_t zigzag(const std::int64_t value)
+{
+	return (static_cast<std::uint64_t>(value) << 1) ^ static_cast<std::uint64_t>(value >> 63);
+}
+
+std::int64_t unzigzag(const std::uint64_t value)
+{
+	return static_cast<std::int64_t>(value >> 1) ^ -static_cast<std::int64_t>(value & 1);
+}
+
+/*!
+Reads the contents of one block, in place.
+*/
+class block_reader
+{
+  public:
+	explicit block_reader(const std::span<const std::uint8_t> block) : rest{block} {}
+
+	std::uint64_t read_varint()
+	{
+		const auto value = decode_varint([this] { return read_byte(); });
+		if (!value)
+			log_error("malformed binary output, varint is too long");
+
+		return *value;
+	}
+
+	std::uint8_t read_byte()
+	{
+		if (rest.empty())
+			log_error("malformed binary output, block ends early");
+
+		const auto byte = rest.front();
+		rest = rest.subspan(1);
+		return byte;
+	}
+
+	template <class int_t>
+	int_t read_int()
+	{
+		return static_cast<int_t>(read_varint());
+	}
+
+	template <class int_t>
+	int_t read_signed()
+	{
+		return static_cast<int_t>(unzigzag(read_varint()));
+	}
+
+	[[nodiscard]] bool empty() const { return rest.empty(); }
+
+  private:
+	std::span<const std::uint8_t> rest;
+};
+
+//! Reads a varint from the stream, returning false at the end of the stream.
+bool read_varint(std::istream& stream, std::uint64_t& value)
+{
+	if (stream.peek() == std::istream::traits_type::eof())
+	{
+		return false;
+	}
+	const auto decoded = decode_varint(
+		[&stream]
+		{
+			const auto c = stream.get();
+			if (c == std::istream::traits_type::eof())
+				log_error("malformed binary output, stream ends early");
+
+			return static_cast<std::uint8_t>(c);
+		});
+	if (!decoded)
+		log_error("malformed binary output, varint is too long");
+
+	value = *decoded;
+	return true;
+}
+
+void write_bytes(std::ostream& out, const std::span<const std::uint8_t> bytes)
+{
+	out.write(reinterpret_cast<const char*>(bytes.data()),
+	          static_cast<std::streamsize>(bytes.size()));
+}
+
+} // namespace
+
+binary_pattern_writer::binary_pattern_writer(std::ostream& out, const std::size_t block_size)
+	: out_{out}, block_size_{std::max<std::size_t>(block_size, 1)}
+{
+	std::vector<std::uint8_t> header(binary_output_magic.begin(), binary_output_magic.end());
+	write_varint(header, format_version);
+	write_bytes(out_, header);
+}
+
+binary_pattern_writer::~binary_pattern_writer() { flush(); }
+
+std::uint64_t binary_pattern_writer::label_index(const int label)
+{
+	const auto [it, inserted] = label_indexes.try_emplace(label, labels.size());
+	if (inserted)
+	{
+		labels.push_back(label);
+	}
+	return it->second;
+}
+
+void binary_pattern_writer::write(const graph_id_t id, const std::span<const dfs_edge_t> codes,
+                                  const std::size_t support,
+                                  const std::span<const graph_id_t> graph_ids)
+{
+	if (std::ranges::adjacent_find(graph_ids, std::ranges::greater_equal{}) != graph_ids.end())
+		log_error("the graph IDs of pattern ", id, " are not in increasing order without repeats");
+
+	write_varint(records, zigzag(std::int64_t{id} - last_id));
+	last_id = id;
+
+	write_varint(records, codes.size());
+	for (const auto& code : codes)
+	{
+		write_varint(records, code.from);
+		write_varint(records, code.to);
+		write_varint(records, label_index(code.from_label));
+		write_varint(records, label_index(code.edge_label));
+		write_varint(records, label_index(code.to_label));
+	}
+
+	write_varint(records, support);
+	if (graph_ids.empty())
+	{
+		records.push_back(static_cast<std::uint8_t>(support_encoding::none));
+	}
+	else
+	{
+		// Whichever of the two is smaller. Both start with the first ID. Differences are taken in
+		// 64 bits, as IDs may be spread over the whole range of graph_id_t.
+		const auto first = static_cast<std::uint64_t>(graph_ids.front());
+		const auto n_bits =
+			static_cast<std::uint64_t>(std::int64_t{graph_ids.back()} - graph_ids.front()) + 1;
+		const auto gap = [graph_ids](const std::size_t i)
+		{ return static_cast<std::uint64_t>(std::int64_t{graph_ids[i]} - graph_ids[i - 1] - 1); };
+		const auto bitset_size = varint_size((n_bits + 7) / 8) + (n_bits + 7) / 8;
+		std::size_t deltas_size = 0;
+		for (std::size_t i = 1; i < graph_ids.size(); ++i)
+		{
+			deltas_size += varint_size(gap(i));
+		}
+		deltas_size += varint_size(graph_ids.size());
+
+		if (deltas_size <= bitset_size)
+		{
+			records.push_back(static_cast<std::uint8_t>(support_encoding::deltas));
+			write_varint(records, graph_ids.size());
+			write_varint(records, first);
+			for (std::size_t i = 1; i < graph_ids.size(); ++i)
+			{
+				write_varint(records, gap(i));
+			}
+		}
+		else
+		{
+			records.push_back(static_cast<std::uint8_t>(support_encoding::bitset));
+			write_varint(records, (n_bits + 7) / 8);
+			write_varint(records, first);
+			const auto bits_start = records.size();
+			records.resize(bits_start + (n_bits + 7) / 8);
+			for (const auto graph_id : graph_ids)
+			{
+				const auto bit = static_cast<std::uint64_t>(graph_id) - first;
+				records[bits_start + bit / 8] |= static_cast<std::uint8_t>(1U << (bit % 8));
+			}
+		}
+	}
+
+	if (++n_patterns == block_size_)
+	{
+		flush();
+	}
+}
+
+void binary_pattern_writer::flush()
+{
+	if (n_patterns == 0)
+	{
+		return;
+	}
+
+	std::vector<std::uint8_t> header;
+	write_varint(header, n_patterns);
+	write_varint(header, labels.size());
+	for (const auto label : labels)
+	{
+		write_varint(header, zigzag(label));
+	}
+
+	std::vector<std::uint8_t> size;
+	write_varint(size, header.size() + records.size());
+	write_bytes(out_, size);
+	write_bytes(out_, header);
+	write_bytes(out_, records);
+
+	n_patterns = 0;
+	last_id = 0;
+	labels.clear();
+	label_indexes.clear();
+	records.clear();
+}
+
+void read_binary_patterns(std::istream& stream,
+                          const std::function<void(binary_pattern_t&&)>& on_pattern)
+{
+	std::string magic(binary_output_magic.size(), '\0');
+	if (!stream.read(magic.data(), static_cast<std::streamsize>(magic.size())) ||
+	    magic != binary_output_magic)
+		log_error("not in the binary output format");
+
+	std::uint64_t version;
+	if (!read_varint(stream, version) || version != format_version)
+		log_error("unsupported binary output version");
+
+	std::vector<std::uint8_t> block;
+	std::vector<int> labels;
+	std::uint64_t block_size;
+	while (read_varint(stream, block_size))
+	{
+		block.resize(block_size);
+		if (!stream.read(reinterpret_cast<char*>(block.data()),
+		                 static_cast<std::streamsize>(block.size())))
+			log_error("malformed binary output, stream ends early");
+
+		block_reader reader{block};
+		const auto n_patterns = reader.read_varint();
+		labels.resize(reader.read_int<std::size_t>());
+		for (auto& label : labels)
+		{
+			label = reader.read_signed<int>();
+		}
+		const auto read_label = [&]
+		{
+			const auto index = reader.read_int<std::size_t>();
+			if (index >= labels.size())
+				log_error("malformed binary output, label ", index, " is not in the dictionary");
+
+			return labels[index];
+		};
+
+		graph_id_t last_id = 0;
+		for (std::uint64_t i = 0; i < n_patterns; ++i)
+		{
+			binary_pattern_t pattern{};
+			pattern.id = static_cast<graph_id_t>(last_id + reader.read_signed<std::int64_t>());
+			last_id = pattern.id;
+
+			pattern.codes.resize(reader.read_int<std::size_t>());
+			for (auto& code : pattern.codes)
+			{
+				code.from = reader.read_int<vertex_id_t>();
+				code.to = reader.read_int<vertex_id_t>();
+				code.from_label = read_label();
+				code.edge_label = read_label();
+				code.to_label = read_label();
+			}
+
+			pattern.support = reader.read_int<std::size_t>();
+			switch (static_cast<support_encoding>(reader.read_byte()))
+			{
+			case support_encoding::none:
+				break;
+			case support_encoding::deltas:
+			{
+				pattern.graph_ids.resize(reader.read_int<std::size_t>());
+				if (pattern.graph_ids.empty())
+					log_error("malformed binary output, empty list of graph IDs");
+
+				pattern.graph_ids[0] = reader.read_int<graph_id_t>();
+				for (std::size_t j = 1; j < pattern.graph_ids.size(); ++j)
+				{
+					const auto gap = reader.read_int<std::int64_t>();
+					pattern.graph_ids[j] =
+						static_cast<graph_id_t>(std::int64_t{pattern.graph_ids[j - 1]} + gap + 1);
+				}
+				break;
+			}
+			case support_encoding::bitset:
+			{
+				const auto n_bytes = reader.read_int<std::size_t>();
+				const auto first = reader.read_int<graph_id_t>();
+				for (std::size_t byte_index = 0; byte_index < n_bytes; ++byte_index)
+				{
+					const auto byte = reader.read_byte();
+					for (unsigned bit = 0; bit < 8; ++bit)
+					{
+						if ((byte >> bit) & 1)
+						{
+							const auto offset = static_cast<std::int64_t>(byte_index * 8 + bit);
+							pattern.graph_ids.push_back(
+								static_cast<graph_id_t>(std::int64_t{first} + offset));
+						}
+					}
+				}
+				break;
+			}
+			default:
+				log_error("malformed binary output, unknown support encoding");
+			}
+
+			on_pattern(std::move(pattern));
+		}
+
+		if (!reader.empty())
+			log_error("malformed binary output, block has trailing bytes");
+	}
+}
+
+} // namespace spang
@@ -0,0 +1,189 @@
+#include <spang/canonical.hpp>
+#include <spang/is_min.hpp>
+#include <spang/logger.hpp>
+#include <spang/utility.hpp>
+
+#include <algorithm>
+#include <utility>
+
+namespace spang
+{
+
+namespace
+{
+
+//! The splitmix64 finalizer.
+constexpr std::uint64_t mix(std::uint64_t x)
+{
+	x ^= x >> 30;
+	x *= 0xbf58476d1ce4e5b9;
+	x ^= x >> 27;
+	x *= 0x94d049bb133111eb;
+	x ^= x >> 31;
+	return x;
+}
+
+/*!
+Hashes a sequence of words into two independent 64-bit halves, each folding in every word with a
+different multiplier.
+*/
+class fingerprint_builder
+{
+  public:
+	template <class int_t>
+	void add(const int_t value)
+	{
+		const auto word = static_cast<std::uint64_t>(static_cast<std::int64_t>(value));
+		low = mix(low ^ (word * 0x9e3779b97f4a7c15));
+		high = mix(high + (word * 0xc2b2ae3d27d4eb4f) + 0x165667b19e3779f9);
+	}
+
+	[[nodiscard]] fingerprint_t get() const { return {.low = low, .high = high}; }
+
+  private:
+	std::uint64_t low{0x243f6a8885a308d3};
+	std::uint64_t high{0x13198a2e03707344};
+};
+
+} // namespace
+
+graph_t to_graph(const parsed_output_graph_base_t& parsed)
+{
+	// Vertex IDs are usually 0 to n - 1 in order, but are not required to be.
+	std::vector<std::pair<parsed_vertex_id_t, vertex_id_t>> indexes;
+	indexes.reserve(parsed.vertices.size());
+
+	graph_t graph{.id = 0, .n_edges = 0, .vertices = {}};
+	graph.vertices.reserve(parsed.vertices.size());
+	for (const auto& vertex : parsed.vertices)
+	{
+		const auto index = static_cast<vertex_id_t>(graph.vertices.size());
+		indexes.emplace_back(vertex.id, index);
+		graph.vertices.push_back(vertex_t{.label = vertex.label, .id = index, .edges = {}});
+	}
+	std::ranges::sort(indexes);
+
+	const auto index_of = [&](const parsed_vertex_id_t id)
+	{
+		const auto it = std::ranges::lower_bound(indexes, std::pair{id, vertex_id_t{0}});
+		if (it == indexes.end() || it->first != id)
+		{
+			log_error("edge refers to vertex ", id, ", which does not exist");
+		}
+		return it->second;
+	};
+
+	for (const auto& edge : parsed.edges)
+	{
+		graph.add_edge(index_of(edge.from), edge.label, index_of(edge.to));
+	}
+
+	return graph;
+}
+
+std::vector<dfs_edge_t> canonical_code(const parsed_output_graph_base_t& parsed)
+{
+	return min_dfs_code(to_graph(parsed));
+}
+
+std::size_t dfs_code_hash::operator()(const std::span<const dfs_edge_t> codes) const
+{
+	std::size_t seed{0};
+	for (const auto& code : codes)
+	{
+		hash_combine(seed, code.from);
+		hash_combine(seed, code.to);
+		hash_combine(seed, code.from_label);
+		hash_combine(seed, code.edge_label);
+		hash_combine(seed, code.to_label);
+	}
+	return seed;
+}
+
+canonical_form_t canonical_form(const parsed_output_graph_base_t& parsed)
+{
+	canonical_form_t form{.code = canonical_code(parsed), .vertex_labels = {}};
+	if (parsed.edges.empty())
+	{
+		for (const auto& vertex : parsed.vertices)
+		{
+			form.vertex_labels.push_back(vertex.label);
+		}
+		std::ranges::sort(form.vertex_labels);
+	}
+	return form;
+}
+
+std::size_t
+canonical_cache::literal_graph_hash::operator()(const literal_graph_t& graph) const
+{
+	fingerprint_builder builder;
+	builder.add(graph.vertices.size());
+	for (const auto& vertex : graph.vertices)
+	{
+		builder.add(vertex.id);
+		builder.add(vertex.label);
+	}
+	for (const auto& edge : graph.edges)
+	{
+		builder.add(edge.from);
+		builder.add(edge.to);
+		builder.add(edge.label);
+	}
+	return static_cast<std::size_t>(builder.get().low);
+}
+
+const canonical_form_t& canonical_cache::get(const parsed_output_graph_base_t& parsed)
+{
+	literal_graph_t key{.vertices = parsed.vertices, .edges = parsed.edges};
+	if (const auto it = forms.find(key); it != forms.end())
+	{
+		return it->second;
+	}
+
+	if (forms.size() >= max_size_)
+	{
+		forms.clear();
+	}
+	return forms.emplace(std::move(key), canonical_form(parsed)).first->second;
+}
+
+fingerprint_t fingerprint(const canonical_form_t& form, const std::size_t support_count,
+                          const std::span<const graph_id_t> support)
+{
+	fingerprint_builder builder;
+
+	builder.add(form.code.size());
+	for (const auto& edge : form.code)
+	{
+		builder.add(edge.from);
+		builder.add(edge.to);
+		builder.add(edge.from_label);
+		builder.add(edge.edge_label);
+		builder.add(edge.to_label);
+	}
+
+	builder.add(form.vertex_labels.size());
+	for (const auto label : form.vertex_labels)
+	{
+		builder.add(label);
+	}
+
+	builder.add(support_count);
+	builder.add(support.size());
+	for (const auto graph_id : support)
+	{
+		builder.add(graph_id);
+	}
+
+	return builder.get();
+}
+
+fingerprint_t fingerprint(const parsed_output_graph_base_t& parsed)
+{
+	auto support = parsed.support;
+	std::ranges::sort(support);
+	return fingerprint(canonical_form(parsed), parsed.support_count, support);
+}
+
+} // namespace spang
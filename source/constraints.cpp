@@ -0,0 +1,133 @@
+#include <spang/constraints.hpp>
+
+#include <algorithm>
+#include <charconv>
+
+namespace spang
+{
+
+namespace
+{
+
+//! Parses the whole of text as a number, if it is one.
+template <class int_t>
+std::optional<int_t> parse_number(const std::string_view text)
+{
+	int_t value{};
+	const auto [end, error] = std::from_chars(text.data(), text.data() + text.size(), value);
+	if (error != std::errc{} || end != text.data() + text.size())
+	{
+		return std::nullopt;
+	}
+	return value;
+}
+
+} // namespace
+
+bool constraints_t::allows_vertex_label(const vertex_label_t label) const
+{
+	return std::ranges::find(forbidden_vertex_labels, label) == forbidden_vertex_labels.end();
+}
+
+bool constraints_t::allows_edge_label(const edge_label_t label) const
+{
+	return std::ranges::find(forbidden_edge_labels, label) == forbidden_edge_labels.end();
+}
+
+bool constraints_t::allows_extension(const std::span<const std::size_t> degrees,
+                                     const std::size_t n_edges, const dfs_edge_t& code) const
+{
+	if (n_edges >= max_edges || !allows_edge_label(code.edge_label))
+	{
+		return false;
+	}
+
+	// A forwards edge adds a vertex with no edges yet, and its label is the only new one, other
+	// than both of the first edge's. Vertices past the end of degrees have no edges either.
+	const auto degree = [degrees](const vertex_id_t vertex) -> std::size_t
+	{ return vertex < degrees.size() ? degrees[vertex] : 0; };
+	if ((code.is_forwards() && !allows_vertex_label(code.to_label)) ||
+	    (n_edges == 0 && !allows_vertex_label(code.from_label)))
+	{
+		return false;
+	}
+	return degree(code.from) < max_degree && degree(code.to) < max_degree;
+}
+
+bool constraints_t::satisfied_by(const std::span<const dfs_edge_t> codes) const
+{
+	const auto has_vertex_label = [codes](const vertex_label_t label)
+	{
+		return std::ranges::any_of(codes, [label](const dfs_edge_t& code)
+		                           { return code.from_label == label || code.to_label == label; });
+	};
+	const auto has_edge_label = [codes](const edge_label_t label)
+	{ return std::ranges::find(codes, label, &dfs_edge_t::edge_label) != codes.end(); };
+
+	return std::ranges::all_of(required_vertex_labels, has_vertex_label) &&
+	       std::ranges::all_of(required_edge_labels, has_edge_label);
+}
+
+std::optional<constraints_t> parse_constraints(std::string_view spec)
+{
+	constraints_t constraints;
+	if (spec.empty())
+	{
+		return constraints;
+	}
+
+	// Every item is followed by a comma but the last.
+	for (bool last = false; !last;)
+	{
+		const auto comma = spec.find(',');
+		last = comma == std::string_view::npos;
+		const auto item = spec.substr(0, comma);
+		spec = last ? std::string_view{} : spec.substr(comma + 1);
+
+		const auto equals = item.find('=');
+		if (equals == std::string_view::npos)
+		{
+			return std::nullopt;
+		}
+		const auto key = item.substr(0, equals);
+		const auto value = item.substr(equals + 1);
+
+		const auto add_limit = [value](std::size_t& limit)
+		{
+			const auto number = parse_number<std::size_t>(value);
+			limit = number.value_or(0);
+			return number.has_value();
+		};
+		const auto add_label = [value](std::vector<int>& labels)
+		{
+			const auto label = parse_number<int>(value);
+			if (label)
+			{
+				labels.push_back(*label);
+			}
+			return label.has_value();
+		};
+
+		bool valid = false;
+		if (key == "max_edges")
+			valid = add_limit(constraints.max_edges);
+		else if (key == "max_degree")
+			valid = add_limit(constraints.max_degree);
+		else if (key == "forbid_vertex")
+			valid = add_label(constraints.forbidden_vertex_labels);
+		else if (key == "forbid_edge")
+			valid = add_label(constraints.forbidden_edge_labels);
+		else if (key == "require_vertex")
+			valid = add_label(constraints.required_vertex_labels);
+		else if (key == "require_edge")
+			valid = add_label(constraints.required_edge_labels);
+
+		if (!valid)
+		{
+			return std::nullopt;
+		}
+	}
+	return constraints;
+}
+
+} // namespace spang
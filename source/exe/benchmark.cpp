@@ -0,0 +1,272 @@
+#include "spang/extend.hpp"
+#include "spang/is_min.hpp"
+#include "spang/label_filter.hpp"
+#include "spang/logger.hpp"
+#include "spang/parser.hpp"
+#include "spang/preprocess.hpp"
+#include "spang/walk.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <fstream>
+#include <limits>
+#include <span>
+#include <string>
+#include <vector>
+
+namespace
+{
+
+/*
+Molecule-like graphs: vertex labels heavily skewed towards one (as carbon is), and a handful of
+bond types, but with far higher degrees or far more vertices than real molecules to stress the
+scans.
+*/
+std::vector<spang::parsed_input_graph_t> make_graphs(const int n_graphs, const int n_vertices,
+                                                     const int degree, const int n_labels)
+{
+	std::uint32_t state = 1;
+	const auto next = [&state](const std::uint32_t bound)
+	{
+		state = state * 1103515245u + 12345u;
+		return (state >> 8) % bound;
+	};
+
+	std::vector<spang::parsed_input_graph_t> graphs;
+	for (int graph_id = 0; graph_id < n_graphs; ++graph_id)
+	{
+		auto& graph = graphs.emplace_back();
+		graph.id = graph_id;
+		for (int vertex = 0; vertex < n_vertices; ++vertex)
+		{
+			const auto label =
+				next(10) < 6 ? 0 : 1 + next(static_cast<std::uint32_t>(n_labels - 1));
+			graph.vertices.push_back(spang::parsed_vertex_t{
+				.id = static_cast<spang::vertex_id_t>(vertex),
+				.label = static_cast<spang::vertex_label_t>(label),
+			});
+		}
+		for (int vertex = 0; vertex < n_vertices; ++vertex)
+		{
+			for (int i = 0; i < degree / 2; ++i)
+			{
+				const auto to = next(static_cast<std::uint32_t>(n_vertices));
+				if (to == static_cast<std::uint32_t>(vertex))
+				{
+					continue;
+				}
+				graph.edges.push_back(spang::parsed_edge_t{
+					.from = static_cast<spang::vertex_id_t>(vertex),
+					.to = static_cast<spang::vertex_id_t>(to),
+					.label = static_cast<spang::edge_label_t>(next(3)),
+				});
+			}
+		}
+	}
+	return graphs;
+}
+
+/*
+Runs the label filter over every adjacency list, with a spread of vertex labels as the minimum, as
+the forwards extensions do. Reports the throughput in adjacency entries (half-edges) per second.
+*/
+void bench_label_filter(const std::span<const spang::compact_graph_t> graphs,
+                        const spang::simd_level level)
+{
+	spang::vertex_label_t max_label = 0;
+	std::size_t max_degree = 0;
+	for (const auto& graph : graphs)
+	{
+		for (const auto label : graph.vertex_labels)
+		{
+			max_label = std::max(max_label, label);
+		}
+		for (std::size_t vertex = 0; vertex < graph.n_vertices(); ++vertex)
+		{
+			max_degree = std::max<std::size_t>(max_degree,
+			                                   graph.offsets[vertex + 1] - graph.offsets[vertex]);
+		}
+	}
+
+	std::vector<spang::compact_graph_t::adjacency_index_t> out(max_degree);
+	std::size_t n_scanned = 0;
+	std::size_t n_kept = 0;
+
+	constexpr spang::vertex_label_t max_n_min_labels = 8;
+	const auto min_label_step = max_label / max_n_min_labels + 1;
+
+	// Aim for the same amount of work regardless of the size of the database.
+	std::size_t n_entries = 0;
+	for (const auto& graph : graphs)
+	{
+		n_entries += graph.neighbours.size();
+	}
+	const auto n_min_labels = static_cast<std::size_t>(max_label / min_label_step + 1);
+	const auto repetitions = std::max<std::size_t>(200'000'000 / (n_entries * n_min_labels), 1);
+	const auto start = std::chrono::steady_clock::now();
+	for (std::size_t repetition = 0; repetition < repetitions; ++repetition)
+	{
+		for (const auto& graph : graphs)
+		{
+			for (std::size_t vertex = 0; vertex < graph.n_vertices(); ++vertex)
+			{
+				const auto first = graph.offsets[vertex];
+				const auto degree = graph.offsets[vertex + 1] - first;
+				const auto labels = std::span{graph.neighbour_labels}.subspan(first, degree);
+				for (spang::vertex_label_t min_label = 0; min_label <= max_label;
+				     min_label += min_label_step)
+				{
+					n_kept += spang::filter_labels_at_least(level, labels, min_label, first, out);
+					n_scanned += labels.size();
+				}
+			}
+		}
+	}
+	const auto end = std::chrono::steady_clock::now();
+
+	const auto seconds = std::chrono::duration<double>(end - start).count();
+	const auto n_scanned_d = static_cast<double>(n_scanned);
+	spang::log_info("  ", spang::to_string(level), ": ", n_scanned_d / seconds / 1e6,
+	                "M entries/s, ", seconds * 1e9 / n_scanned_d, "ns per entry (kept ", n_kept,
+	                ")");
+}
+
+struct store_stats
+{
+	std::size_t n_patterns = 0;
+	std::size_t n_embeddings = 0;
+	std::size_t n_bytes = 0;
+};
+
+void mine_projections(const std::span<const spang::compact_graph_t> graphs,
+                      const spang::walk_limits limits, std::vector<spang::dfs_edge_t>& codes,
+                      const std::span<const spang::dfs_projection_link> projections,
+                      store_stats& stats)
+{
+	spang::walk_projections(graphs, limits, codes, projections,
+	                        [&stats](const auto&, const auto& links)
+	                        {
+								++stats.n_patterns;
+								stats.n_embeddings += links.size();
+								stats.n_bytes += links.size() * sizeof(spang::dfs_projection_link);
+							});
+}
+
+void mine_embeddings(const std::span<const spang::compact_graph_t> graphs,
+                     const spang::walk_limits limits, std::vector<spang::dfs_edge_t>& codes,
+                     const spang::embedding_list& embeddings, store_stats& stats)
+{
+	spang::walk_embeddings(
+		graphs, limits, codes, embeddings,
+		[&stats](const auto&, const spang::embedding_list& list)
+		{
+			++stats.n_patterns;
+			stats.n_embeddings += list.size();
+			stats.n_bytes += list.size() * (sizeof(spang::graph_id_t) +
+			                                list.n_vertices() * sizeof(spang::vertex_id_t) +
+			                                list.n_edges() * sizeof(spang::edge_id_t));
+		});
+}
+
+template <class seed_t, class mine_t>
+void bench_store(const char* store_name, const std::span<const spang::compact_graph_t> graphs,
+                 const spang::walk_limits limits, seed_t seed, mine_t mine)
+{
+	store_stats stats;
+	const auto start = std::chrono::steady_clock::now();
+	for (const auto& [code, embeddings] : seed(graphs))
+	{
+		std::vector codes{code};
+		mine(graphs, limits, codes, embeddings, stats);
+	}
+	const auto end = std::chrono::steady_clock::now();
+
+	const auto seconds = std::chrono::duration<double>(end - start).count();
+	spang::log_info("  ", store_name, ": ", seconds, "s, ", stats.n_patterns, " patterns, ",
+	                stats.n_embeddings, " embeddings, ",
+	                static_cast<double>(stats.n_bytes) / (1024 * 1024), "MiB stored in total");
+}
+
+/*
+Mines with each way of storing embeddings, without reporting. Patterns are limited to max_edges
+edges, to keep the runtime down on dense graphs.
+*/
+void bench_stores(const std::span<const spang::compact_graph_t> graphs,
+                  const spang::walk_limits limits)
+{
+	if (limits.max_edges == std::numeric_limits<std::size_t>::max())
+		spang::log_info(" mining at support ", limits.min_freq);
+	else
+		spang::log_info(" mining at support ", limits.min_freq, ", up to ", limits.max_edges,
+		                " edges");
+
+	bench_store(
+		"projection links", graphs, limits,
+		[](const auto& database) { return spang::extend(database); }, mine_projections);
+	bench_store(
+		"embedding lists", graphs, limits,
+		[](const auto& database) { return spang::extend_embeddings(database); },
+		mine_embeddings);
+}
+
+void bench(const char* name, std::vector<spang::parsed_input_graph_t>&& input,
+           const spang::walk_limits limits)
+{
+	auto input_copy = input;
+	const auto graphs = spang::preprocess(std::move(input_copy), 1);
+
+	std::size_t n_entries = 0;
+	for (const auto& graph : graphs)
+	{
+		n_entries += graph.neighbours.size();
+	}
+	spang::log_info(name, ": ", graphs.size(), " graphs, ", n_entries, " adjacency entries");
+
+	const auto supported = spang::detect_simd_level();
+	for (const auto level :
+	     {spang::simd_level::scalar, spang::simd_level::avx2, spang::simd_level::avx512})
+	{
+		if (level <= supported)
+		{
+			bench_label_filter(graphs, level);
+		}
+	}
+
+	bench_stores(spang::preprocess(std::move(input), limits.min_freq), limits);
+}
+
+} // namespace
+
+int main(int argc, char* argv[])
+{
+	if (argc > 3)
+		spang::log_error("usage: ", argv[0], " [path [min_freq]]\n",
+		                 "Benchmarks on generated dense graphs, ",
+		                 "and on the given input file if any.");
+
+	spang::log_info("Detected instruction set: ", spang::to_string(spang::detect_simd_level()));
+
+	bench("dense (degree 8)", make_graphs(500, 64, 8, 5), {.min_freq = 250, .max_edges = 3});
+	bench("dense (degree 32)", make_graphs(200, 128, 32, 5), {.min_freq = 150, .max_edges = 2});
+	// Large graphs with many labels, so that each pattern only has a few embeddings in each graph.
+	// Anything proportional to the graph size per graph visited shows up here.
+	bench("large (degree 2)", make_graphs(200, 20000, 2, 1000), {.min_freq = 40, .max_edges = 3});
+
+	if (argc >= 2)
+	{
+		std::ifstream in(argv[1]);
+		if (!in)
+			spang::log_error("Could not open ", argv[1]);
+
+		spang::input_parser parser;
+		parser.read(in);
+		auto graphs = parser.get_graphs();
+
+		// Default to 10% of the graphs
+		const auto min_freq =
+			argc == 3 ? std::stoul(argv[2]) : std::max<std::size_t>(graphs.size() / 10, 1);
+		bench(argv[1], std::move(graphs),
+		      {.min_freq = min_freq, .max_edges = std::numeric_limits<std::size_t>::max()});
+	}
+}
@@ -0,0 +1,70 @@
+#include "spang/binary_output.hpp"
+#include "spang/canonical.hpp"
+#include "spang/logger.hpp"
+#include "spang/parser.hpp"
+#include "spang/report.hpp"
+
+#include <algorithm>
+#include <filesystem>
+#include <fstream>
+#include <string>
+
+namespace
+{
+
+bool is_binary(const std::filesystem::path& path)
+{
+	std::ifstream in(path, std::ios::binary);
+	std::string magic(spang::binary_output_magic.size(), '\0');
+	return in.read(magic.data(), static_cast<std::streamsize>(magic.size())) &&
+	       magic == spang::binary_output_magic;
+}
+
+void binary_to_text(const std::filesystem::path& input, std::ostream& out)
+{
+	std::ifstream in(input, std::ios::binary);
+	spang::read_binary_patterns(in,
+	                            [&out](spang::binary_pattern_t&& pattern)
+	                            {
+									spang::write_text_pattern(out, pattern.id, pattern.codes,
+			                                                  pattern.support, pattern.graph_ids);
+								});
+}
+
+//! Patterns are stored by their canonical code, so vertices may be renumbered.
+void text_to_binary(const std::filesystem::path& input, std::ostream& out)
+{
+	spang::binary_pattern_writer writer{out};
+	spang::read_output_file(input,
+	                        [&writer](spang::parsed_output_graph_t&& graph)
+	                        {
+								// The binary format stores each graph ID once.
+								std::ranges::sort(graph.support);
+								graph.support.erase(std::ranges::unique(graph.support).begin(),
+				                                    graph.support.end());
+								writer.write(graph.id, spang::canonical_code(graph),
+			                                 graph.support_count, graph.support);
+							});
+}
+
+} // namespace
+
+int main(int argc, char* argv[])
+{
+	if (argc != 3)
+		spang::log_error("usage: ", argv[0], " <input> <output>\n",
+		                 "Converts a result in the binary output format to the text format, ",
+		                 "or one in the text format to the binary format.");
+
+	const std::filesystem::path input(argv[1]), output(argv[2]);
+	if (is_binary(input))
+	{
+		std::ofstream out(output);
+		binary_to_text(input, out);
+	}
+	else
+	{
+		std::ofstream out(output, std::ios::binary);
+		text_to_binary(input, out);
+	}
+}
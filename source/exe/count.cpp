@@ -0,0 +1,53 @@
+#include <spang/canonical.hpp>
+#include <spang/logger.hpp>
+#include <spang/match.hpp>
+#include <spang/parser.hpp>
+#include <spang/preprocess.hpp>
+#include <spang/report.hpp>
+
+#include <algorithm>
+#include <fstream>
+#include <iostream>
+#include <thread>
+#include <vector>
+
+int main(int argc, char* argv[])
+{
+	if (argc != 3 && argc != 4)
+		spang::log_error("usage: ", argv[0], " <input> <patterns> [support | graph_ids]\n",
+		                 "Counts the support of each pattern of a result in the text output ",
+		                 "format in the input graphs, writing them again with their new support.");
+
+	const char* report = argc == 4 ? argv[3] : "support";
+	const auto level = spang::parse_report_level(report);
+	if (!level || *level == spang::report_level::none)
+		spang::log_error("unknown report level \"", report, "\", expected support or graph_ids");
+
+	std::ifstream in(argv[1]);
+	if (!in)
+		spang::log_error("could not open ", argv[1]);
+
+	// Nothing can be pruned, as the patterns need not be frequent.
+	const auto graphs = spang::preprocess_narrowest(in, 1);
+
+	std::vector<spang::graph_id_t> ids;
+	std::vector<std::vector<spang::dfs_edge_t>> patterns;
+	spang::read_output_file(argv[2],
+	                        [&](spang::parsed_output_graph_t&& pattern)
+	                        {
+								ids.push_back(pattern.id);
+								patterns.push_back(spang::canonical_code(pattern));
+							});
+
+	const auto supports = spang::match_patterns(graphs, patterns,
+	                                            std::max(std::thread::hardware_concurrency(), 1U));
+
+	// Patterns are written with their canonical codes, so vertices may be renumbered.
+	for (std::size_t i = 0; i < patterns.size(); ++i)
+	{
+		spang::write_text_pattern(std::cout, ids[i], patterns[i], supports[i].size(),
+		                          *level == spang::report_level::graph_ids
+		                              ? std::span<const spang::graph_id_t>{supports[i]}
+		                              : std::span<const spang::graph_id_t>{});
+	}
+}
@@ -1,15 +1,43 @@
+#include <spang/constraints.hpp>
+#include <spang/logger.hpp>
+#include <spang/mine.hpp>
+#include <spang/preprocess.hpp>
+#include <spang/parser.hpp>
+#include <spang/report.hpp>
+#include <spang/seeded.hpp>
+#include <spang/support.hpp>
+
 #include <cli151/cli151.hpp>
 #include <cli151/macros.hpp>
 
+#include <algorithm>
+#include <fstream>
 #include <iostream>
+#include <thread>
+#include <utility>
+#include <vector>
 
 struct CLI
 {
 	// TODO: cli151 should check that these are required
 	const char* file = "";
 	std::size_t min_freq;
+	// How much to report about each pattern: none, support or graph_ids.
+	const char* report = "support";
+	// Constraints on the patterns mined, such as "max_edges=5,forbid_vertex=3". See
+	// spang::parse_constraints().
+	const char* constraints = "";
+	// A file holding a single graph in the input format. If given, only patterns containing it are
+	// mined.
+	const char* seed = "";
+	// How support is counted: graphs, the number of input graphs a pattern occurs in, or
+	// minimum_image, for mining a single large graph.
+	const char* support = "graphs";
+	// The format patterns are written to stdout in: text or binary.
+	const char* output = "text";
 };
-CLI151_CLI(CLI, &T::file, &T::min_freq)
+CLI151_CLI(CLI, &T::file, &T::min_freq, &T::report, &T::constraints, &T::seed, &T::support,
+           &T::output)
 
 int main(int argc, char* argv[])
 {
@@ -20,8 +48,56 @@ int main(int argc, char* argv[])
 		return 1;
 	}
 
-	const auto [file, min_freq] = *options;
+	const auto [file, min_freq, report, constraints_spec, seed_file, support, output] = *options;
+
+	const auto level = spang::parse_report_level(report);
+	if (!level)
+		spang::log_error("unknown report level \"", report,
+		                 "\", expected none, support or graph_ids");
+
+	const auto constraints = spang::parse_constraints(constraints_spec);
+	if (!constraints)
+		spang::log_error("invalid constraints \"", constraints_spec, "\"");
+
+	const auto measure = spang::parse_support_measure(support);
+	if (!measure)
+		spang::log_error("unknown support measure \"", support,
+		                 "\", expected graphs or minimum_image");
+
+	const auto format = spang::parse_output_format(output);
+	if (!format)
+		spang::log_error("unknown output format \"", output, "\", expected text or binary");
+
+	std::ifstream in(file);
+	if (!in)
+		spang::log_error("could not open ", file);
+
+	spang::report_sink sink{std::cout, *format};
+	const std::size_t n_threads = std::max(std::thread::hardware_concurrency(), 1U);
+
+	// Preprocessing prunes labels by the number of graphs they are in, which only bounds support
+	// counted in graphs.
+	const auto graphs = spang::preprocess_narrowest(
+		in, *measure == spang::support_measure::graphs ? min_freq : 1, n_threads, *constraints);
+
+	if (*seed_file != '\0')
+	{
+		if (*measure != spang::support_measure::graphs)
+			spang::log_error("seeded mining only counts support in graphs");
+
+		std::ifstream seed_in(seed_file);
+		if (!seed_in)
+			spang::log_error("could not open ", seed_file);
+
+		std::vector<spang::parsed_input_graph_t> seeds;
+		spang::read_input_graphs(seed_in, [&seeds](spang::parsed_input_graph_t&& seed)
+		                         { seeds.push_back(std::move(seed)); });
+		if (seeds.size() != 1)
+			spang::log_error(seed_file, " should hold exactly one graph, but has ", seeds.size());
+
+		spang::mine_seeded(graphs, seeds.front(), min_freq, *level, *constraints, nullptr, sink);
+		return 0;
+	}
 
-	std::cout << "File: " << file << '\n';
-	std::cout << "Min frequency: " << min_freq << '\n';
+	spang::mine(graphs, min_freq, n_threads, *measure, *level, *constraints, sink);
 }
@@ -0,0 +1,87 @@
+#include <spang/incremental.hpp>
+#include <spang/logger.hpp>
+#include <spang/parser.hpp>
+#include <spang/preprocess.hpp>
+#include <spang/report.hpp>
+
+#include <algorithm>
+#include <charconv>
+#include <cstddef>
+#include <fstream>
+#include <string_view>
+#include <thread>
+#include <unordered_set>
+#include <utility>
+#include <variant>
+#include <vector>
+
+namespace
+{
+
+void read_graphs(const char* file, std::vector<spang::parsed_input_graph_t>& graphs)
+{
+	std::ifstream in(file);
+	if (!in)
+		spang::log_error("could not open ", file);
+
+	spang::read_input_graphs(in, [&graphs](spang::parsed_input_graph_t&& graph)
+	                         { graphs.push_back(std::move(graph)); });
+}
+
+} // namespace
+
+int main(int argc, char* argv[])
+{
+	if (argc != 5 && argc != 6)
+		spang::log_error("usage: ", argv[0], " <old input> <new input> <previous results> ",
+		                 "<min support> [report]\n",
+		                 "Mines the old and new input graphs together, given the results of ",
+		                 "mining the old ones alone with the same min support at the graph_ids ",
+		                 "report level. The report level defaults to graph_ids, so the output can ",
+		                 "be updated again.");
+
+	const std::string_view min_freq_arg{argv[4]};
+	std::size_t min_freq{};
+	const auto [end, error] =
+		std::from_chars(min_freq_arg.data(), min_freq_arg.data() + min_freq_arg.size(), min_freq);
+	if (error != std::errc{} || end != min_freq_arg.data() + min_freq_arg.size())
+		spang::log_error("invalid min support \"", min_freq_arg, "\"");
+
+	const char* report = argc == 6 ? argv[5] : "graph_ids";
+	const auto level = spang::parse_report_level(report);
+	if (!level)
+		spang::log_error("unknown report level \"", report,
+		                 "\", expected none, support or graph_ids");
+
+	std::vector<spang::parsed_input_graph_t> input;
+	read_graphs(argv[1], input);
+	std::unordered_set<spang::graph_id_t> old_ids;
+	for (const auto& graph : input)
+	{
+		old_ids.insert(graph.id);
+	}
+
+	const auto n_old_input = input.size();
+	read_graphs(argv[2], input);
+	for (std::size_t i = n_old_input; i < input.size(); ++i)
+	{
+		if (old_ids.contains(input[i].id))
+			spang::log_error("graph ", input[i].id, " of ", argv[2],
+			                 " is also one of the old graphs");
+	}
+
+	const auto previous = spang::read_previous_results(argv[3]);
+
+	// Preprocessing keeps the graphs in order, so the old ones are still first.
+	const auto graphs = spang::preprocess_narrowest(
+		std::move(input), min_freq, std::max(std::thread::hardware_concurrency(), 1U));
+	const auto n_old = std::visit(
+		[&old_ids](const auto& database)
+		{
+			return static_cast<std::size_t>(std::ranges::count_if(
+				database, [&old_ids](const auto& graph) { return old_ids.contains(graph.id); }));
+		},
+		graphs);
+
+	spang::mine_incremental(graphs, n_old, previous, min_freq, *level);
+}
@@ -1,44 +1,349 @@
+#include "spang/canonical.hpp"
 #include "spang/logger.hpp"
 #include "spang/parser.hpp"
 
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
 #include <filesystem>
-#include <fstream>
+#include <functional>
+#include <iostream>
+#include <span>
+#include <string_view>
+#include <thread>
+#include <unordered_map>
+#include <vector>
 
-void read(spang::output_parser& parse, const std::filesystem::path& path)
+namespace
 {
+
+//! The files immediately within path if it is a directory, otherwise just path.
+std::vector<std::filesystem::path> list_files(const std::filesystem::path& path)
+{
+	std::vector<std::filesystem::path> files;
 	if (std::filesystem::is_directory(path))
 	{
 		for (const auto& sub_path : std::filesystem::directory_iterator(path))
 		{
 			if (!std::filesystem::is_directory(sub_path))
 			{
-				std::ifstream in(sub_path.path());
-				parse.read(in);
+				files.push_back(sub_path.path());
 			}
 		}
 	}
 	else
 	{
-		std::ifstream in(path);
-		parse.read(in);
+		files.push_back(path);
 	}
+	return files;
 }
 
-int main(int argc, char* argv[])
+std::size_t n_threads() { return std::max(std::thread::hardware_concurrency(), 1U); }
+
+//! An output file, with the sign its patterns are counted with: 1 from the first result, -1 from
+//! the second.
+struct result_file_t
+{
+	std::filesystem::path path;
+	std::int64_t sign;
+};
+
+//! Both results' files, in order.
+std::vector<result_file_t> list_results(const std::filesystem::path& path1,
+                                        const std::filesystem::path& path2)
+{
+	std::vector<result_file_t> files;
+	for (const auto& file : list_files(path1))
+	{
+		files.push_back({.path = file, .sign = 1});
+	}
+	for (const auto& file : list_files(path2))
+	{
+		files.push_back({.path = file, .sign = -1});
+	}
+	return files;
+}
+
+/*!
+Calls read(state, file) for each file, spread over a thread per core, each reading whole files with
+its own state. Returns the states of all threads.
+*/
+template <class state_t, class read_t>
+std::vector<state_t> read_in_parallel(const std::span<const result_file_t> files, read_t read)
+{
+	std::vector<state_t> states(std::max<std::size_t>(std::min(n_threads(), files.size()), 1));
+	std::atomic<std::size_t> next_file{0};
+
+	const auto work = [&](state_t& state)
+	{
+		for (auto i = next_file++; i < files.size(); i = next_file++)
+		{
+			read(state, files[i]);
+		}
+	};
+
+	std::vector<std::thread> helpers;
+	helpers.reserve(states.size() - 1);
+	for (std::size_t i = 1; i < states.size(); ++i)
+	{
+		helpers.emplace_back(work, std::ref(states[i]));
+	}
+	work(states[0]);
+	for (auto& helper : helpers)
+	{
+		helper.join();
+	}
+
+	return states;
+}
+
+void print_graph(const spang::parsed_output_graph_t& graph)
+{
+	std::cout << "t # " << graph.id << " * " << graph.support_count << '\n';
+	for (const auto& vertex : graph.vertices)
+	{
+		std::cout << "v " << vertex.id << ' ' << vertex.label << '\n';
+	}
+	for (const auto& edge : graph.edges)
+	{
+		std::cout << "e " << edge.from << ' ' << edge.to << ' ' << edge.label << '\n';
+	}
+	if (!graph.support.empty())
+	{
+		std::cout << "x:";
+		for (const auto id : graph.support)
+		{
+			std::cout << ' ' << id;
+		}
+		std::cout << '\n';
+	}
+}
+
+//! Compares the results literally, holding both in memory.
+bool compare_literal(const std::filesystem::path& path1, const std::filesystem::path& path2)
 {
 	spang::output_parser parse1, parse2;
 
-	if (argc != 3)
-		spang::log_error("usage: ", argv[0], " <path1> <path2>\n",
-		                 "File paths read directly from the given file, ",
-		                 "directories read all files immediately within them.");
+	parse1.read(list_files(path1), n_threads());
+	parse2.read(list_files(path2), n_threads());
 
-	std::filesystem::path path1(argv[1]), path2(argv[2]);
+	return parse1.get_graphs() == parse2.get_graphs();
+}
+
+//! A pattern up to isomorphism, with its support list sorted.
+struct canonical_pattern_t
+{
+	spang::canonical_form_t form;
+	std::size_t support_count;
+	std::vector<spang::graph_id_t> support;
+
+	bool operator==(const canonical_pattern_t&) const = default;
+};
+
+struct canonical_pattern_hash
+{
+	std::size_t operator()(const canonical_pattern_t& pattern) const
+	{
+		return spang::fingerprint_hash{}(
+			spang::fingerprint(pattern.form, pattern.support_count, pattern.support));
+	}
+};
+
+//! The net number of times each pattern appears, positive if more often in the first result.
+using canonical_counts =
+	std::unordered_map<canonical_pattern_t, std::int64_t, canonical_pattern_hash>;
+
+//! What each thread reads: the net counts, and the forms it has canonicalised.
+struct canonical_state_t
+{
+	canonical_counts counts;
+	spang::canonical_cache cache;
+};
+
+//! Prints a canonical pattern in the output format, with its vertices numbered in DFS order.
+void print_canonical(const canonical_pattern_t& pattern)
+{
+	spang::parsed_output_graph_t graph{};
+	graph.support_count = pattern.support_count;
+	graph.support = pattern.support;
+	for (const auto& code : pattern.form.code)
+	{
+		if (graph.vertices.empty())
+		{
+			graph.vertices.push_back({.id = code.from, .label = code.from_label});
+		}
+		if (code.is_forwards())
+		{
+			graph.vertices.push_back({.id = code.to, .label = code.to_label});
+		}
+		graph.edges.push_back({.from = code.from, .to = code.to, .label = code.edge_label});
+	}
+	for (const auto label : pattern.form.vertex_labels)
+	{
+		graph.vertices.push_back(
+			{.id = static_cast<spang::parsed_vertex_id_t>(graph.vertices.size()), .label = label});
+	}
+	print_graph(graph);
+}
+
+/*!
+Compares the results up to isomorphism of the patterns, holding the canonical form of each distinct
+pattern with the net number of times it appears, and prints the patterns whose counts do not cancel
+out, so that a pattern written twice in one result is found too.
+*/
+bool compare_canonical(const std::filesystem::path& path1, const std::filesystem::path& path2)
+{
+	const auto files = list_results(path1, path2);
+	auto states = read_in_parallel<canonical_state_t>(
+		files,
+		[](canonical_state_t& state, const result_file_t& file)
+		{
+			spang::read_output_file(file.path,
+			                        [&](spang::parsed_output_graph_t&& graph)
+			                        {
+										std::ranges::sort(graph.support);
+										canonical_pattern_t pattern{
+											.form = state.cache.get(graph),
+											.support_count = graph.support_count,
+											.support = std::move(graph.support)};
+										state.counts[std::move(pattern)] += file.sign;
+									});
+		});
+
+	auto& differences = states[0].counts;
+	for (std::size_t i = 1; i < states.size(); ++i)
+	{
+		for (auto& [pattern, count] : states[i].counts)
+		{
+			differences[pattern] += count;
+		}
+	}
+	std::erase_if(differences, [](const auto& entry) { return entry.second == 0; });
+	if (differences.empty())
+	{
+		return true;
+	}
+
+	spang::log_info(differences.size(), " patterns differ");
+	for (const auto& [pattern, count] : differences)
+	{
+		std::cout << "# " << (count > 0 ? count : -count) << " more in "
+				  << (count > 0 ? path1 : path2) << '\n';
+		print_canonical(pattern);
+	}
+	return false;
+}
+
+//! The net number of times each pattern appears, positive if more often in the first result.
+using fingerprint_counts =
+	std::unordered_map<spang::fingerprint_t, std::int64_t, spang::fingerprint_hash>;
+
+//! What each thread reads: the net counts, and the forms it has canonicalised.
+struct counting_state_t
+{
+	fingerprint_counts counts;
+	spang::canonical_cache cache;
+};
+
+spang::fingerprint_t fingerprint(spang::canonical_cache& cache, spang::parsed_output_graph_t& graph)
+{
+	std::ranges::sort(graph.support);
+	return spang::fingerprint(cache.get(graph), graph.support_count, graph.support);
+}
+
+/*!
+Counts every file, spread over a thread per core, each counting whole files into its own map. Only
+the fingerprints whose counts do not cancel out are returned.
+*/
+fingerprint_counts count_differences(const std::span<const result_file_t> files)
+{
+	auto states = read_in_parallel<counting_state_t>(
+		files,
+		[](counting_state_t& state, const result_file_t& file)
+		{
+			spang::read_output_file(file.path,
+			                        [&](spang::parsed_output_graph_t&& graph)
+			                        {
+										state.counts[fingerprint(state.cache, graph)] += file.sign;
+									});
+		});
+
+	auto& differences = states[0].counts;
+	for (std::size_t i = 1; i < states.size(); ++i)
+	{
+		for (const auto& [fingerprint, count] : states[i].counts)
+		{
+			differences[fingerprint] += count;
+		}
+	}
+	std::erase_if(differences, [](const auto& entry) { return entry.second == 0; });
+	return std::move(differences);
+}
+
+/*!
+Compares the results up to isomorphism of the patterns, holding only a fingerprint of each distinct
+pattern. Patterns that differ are found again by a second pass over the files, and printed.
+*/
+bool compare_streaming(const std::filesystem::path& path1, const std::filesystem::path& path2)
+{
+	const auto files = list_results(path1, path2);
+	auto differences = count_differences(files);
+	if (differences.empty())
+	{
+		return true;
+	}
+
+	spang::log_info(differences.size(), " patterns differ");
+	spang::canonical_cache cache;
+	for (const auto& file : files)
+	{
+		if (differences.empty())
+		{
+			break;
+		}
+
+		spang::read_output_file(
+			file.path,
+			[&](spang::parsed_output_graph_t&& graph)
+			{
+				const auto it = differences.find(fingerprint(cache, graph));
+				// Print each pattern once, from the result it appears more often in.
+				if (it == differences.end() || it->second * file.sign < 0)
+				{
+					return;
+				}
+				const auto count = it->second * file.sign;
+				differences.erase(it);
+
+				std::cout << "# " << count << " more in " << (file.sign > 0 ? path1 : path2)
+						  << '\n';
+				print_graph(graph);
+			});
+	}
+	return false;
+}
+
+} // namespace
+
+int main(int argc, char* argv[])
+{
+	const std::string_view mode = argc == 4 ? argv[1] : "";
+	if (!(argc == 3 || (argc == 4 && (mode == "--literal" || mode == "--stream"))))
+		spang::log_error("usage: ", argv[0], " [--literal | --stream] <path1> <path2>\n",
+		                 "File paths read directly from the given file, ",
+		                 "directories read all files immediately within them, in parallel.\n",
+		                 "Patterns are compared up to isomorphism, and those that differ are ",
+		                 "printed.\n",
+		                 "--literal compares vertex numbering and edge order too.\n",
+		                 "--stream holds only a fingerprint of each pattern, rather than ",
+		                 "the patterns themselves.");
 
-	read(parse1, path1);
-	read(parse2, path2);
+	std::filesystem::path path1(argv[argc - 2]), path2(argv[argc - 1]);
 
-	if (parse1.get_graphs() != parse2.get_graphs())
+	const bool same = mode == "--literal"  ? compare_literal(path1, path2)
+	                  : mode == "--stream" ? compare_streaming(path1, path2)
+	                                       : compare_canonical(path1, path2);
+	if (!same)
 	{
 		spang::log_info("Results differ");
 	}
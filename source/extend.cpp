@@ -1,132 +1,183 @@
 #include <spang/extend.hpp>
+#include <spang/label_filter.hpp>
 #include <spang/projection.hpp>
+#include <spang/scheduler.hpp>
 
 #include <algorithm>
+#include <cassert>
+#include <cstdint>
+#include <limits>
 #include <ranges>
 #include <span>
+#include <unordered_map>
+#include <vector>
 
 namespace spang
 {
 
 namespace
 {
+using adjacency_index_t = compact_graph_t::adjacency_index_t;
+
 /*
-Adds candidate backwards edges to the extension map.
+Returns the candidates in [first, last) whose neighbour label is at least min_label. The result is
+stored in scratch, so is only valid until the next call.
 */
-void extend_backwards(const dfs_projection_link& subinstance, const projection_view& instance_view,
-                      const compact_graph_t& graph, const std::span<const dfs_edge_t> dfs_code_list,
-                      const std::span<const edge_id_t> rightmost_path, extension_map& map)
+template <class local_id_t>
+std::span<const adjacency_index_t>
+admissible_candidates(const basic_compact_graph_t<local_id_t>& graph, const adjacency_index_t first,
+                      const adjacency_index_t last, const vertex_label_t min_label,
+                      std::vector<adjacency_index_t>& scratch)
 {
-	const auto& last_edge = instance_view.get_edge(rightmost_path[0]);
-	const auto& last_node = graph.vertices[last_edge.to];
+	const std::size_t n_candidates = last - first;
+	if (scratch.size() < n_candidates)
+	{
+		scratch.resize(n_candidates);
+	}
+	const auto n_admissible = filter_labels_at_least(
+		std::span{graph.neighbour_labels}.subspan(first, n_candidates), min_label, first, scratch);
+	return std::span{scratch}.first(n_admissible);
+}
 
-	// TODO lots of overlap with is_backwards_min in is_min.cpp, maybe could be extracted
-	for (const auto& edge_from_last_node : last_node.edges)
+/*
+Calls process_graph(graph_id, first, last) for each run [first, last) of consecutive instances in
+the same graph. Extension produces instances grouped by graph, so each graph is visited once.
+*/
+template <class get_graph_id_t, class process_graph_t>
+void for_each_graph(const std::size_t n_instances, get_graph_id_t get_graph_id,
+                    process_graph_t process_graph)
+{
+	std::size_t first = 0;
+	while (first < n_instances)
 	{
-		if (instance_view.has_edge(edge_from_last_node.id))
+		const auto graph_id = get_graph_id(first);
+		auto last = first + 1;
+		while (last < n_instances && get_graph_id(last) == graph_id)
 		{
-			// Only looking for edges we could possibly add, skip existing ones
-			continue;
+			++last;
 		}
+		process_graph(graph_id, first, last);
+		first = last;
+	}
+}
 
-		// Check which RMP vertex this connects to.
-		// We are checking the from fields of each edge, so skip the first one
-		// since that's where the RMV came from.
-		const auto rmp_candidate_edges = rightmost_path | std::views::drop(1);
+/*
+Finds candidate backwards edges, passing each to add_extension along with its DFS code.
+*/
+template <class view_t, class local_id_t, class add_extension_t>
+void extend_backwards(const view_t& instance_view, const basic_compact_graph_t<local_id_t>& graph,
+                      const std::span<const dfs_edge_t> dfs_code_list,
+                      const std::span<const edge_id_t> rightmost_path,
+                      const rightmost_path_lookup& rmp_lookup, add_extension_t& add_extension)
+{
+	const auto& last_edge = instance_view.get_edge(rightmost_path[0]);
+	const auto last_node = last_edge.to;
+	const auto last_node_label = graph.vertex_labels[last_node];
 
-		const auto rmp_edge_index =
-			std::ranges::find_if(rmp_candidate_edges,
-		                         [&instance_view, &edge_from_last_node](const auto edge_index)
-		                         {
-									 const auto& rmp_edge = instance_view.get_edge(edge_index);
-									 return edge_from_last_node.to == rmp_edge.from;
-								 });
+	// The pre-pruning below rejects any edge with a smaller label than every RMP edge it could
+	// close a cycle with, and adjacency lists are sorted by edge label, so skip those outright.
+	auto min_edge_label = std::numeric_limits<edge_label_t>::max();
+	for (const auto rmp_index : rightmost_path | std::views::drop(1))
+	{
+		min_edge_label = std::min(min_edge_label, dfs_code_list[rmp_index].edge_label);
+	}
+	const auto adjacency_end = graph.offsets[last_node + 1u];
+	const auto adjacency_begin =
+		graph.lower_bound(graph.offsets[last_node], adjacency_end, min_edge_label,
+	                      std::numeric_limits<vertex_label_t>::min());
 
-		if (rmp_edge_index == rmp_candidate_edges.end())
+	for (auto candidate = adjacency_begin; candidate < adjacency_end; ++candidate)
+	{
+		if (instance_view.has_edge(graph.edge_ids[candidate]))
 		{
-			// Maybe could check if this vertex has been added before the search
+			// Only looking for edges we could possibly add, skip existing ones
 			continue;
 		}
 
-		const auto& rmp_edge = instance_view.get_edge(*rmp_edge_index);
-
-		// Overlap ends here
+		// Check which RMP vertex this connects to, if any.
+		const auto rmp_index =
+			rmp_lookup.backwards_target(instance_view, graph.neighbours[candidate]);
+		if (rmp_index == rightmost_path_lookup::no_edge)
+		{
+			continue;
+		}
+		const auto& rmp_code = dfs_code_list[rmp_index];
 
-		const auto& rmp_to_node = graph.vertices[rmp_edge.to];
+		const auto candidate_label = graph.edge_labels[candidate];
 
 		// Pre-pruning: If the new edge's label is smaller than the existing (RMP) label, then
 		// it could have been added previously, so this will not be a minimum DFS code.
 		// Failing that, similarly, if the edge labels are the same then check the node labels.
 		// If the last node's label is smaller, then it could have been added before, and thus
 		// also would produce a smaller DFS code.
-		if (lexicographic_leq(rmp_edge.label, edge_from_last_node.label, rmp_to_node.label,
-		                      last_node.label))
+		if (lexicographic_leq(rmp_code.edge_label, candidate_label, rmp_code.to_label,
+		                      last_node_label))
 		{
-			const auto& rmp_from_node = graph.vertices[rmp_edge.from];
-			const auto from_id = dfs_code_list[rightmost_path[0]].to;
-			const auto to_id = dfs_code_list[*rmp_edge_index].from;
 			const dfs_edge_t new_code{
-				.from = from_id,
-				.to = to_id,
-				.from_label = last_node.label,
-				.edge_label = edge_from_last_node.label,
-				.to_label = rmp_from_node.label,
+				.from = dfs_code_list[rightmost_path[0]].to,
+				.to = rmp_code.from,
+				.from_label = last_node_label,
+				.edge_label = candidate_label,
+				.to_label = graph.neighbour_labels[candidate],
 			};
-			map[new_code].push_back(dfs_projection_link{
-				.graph_id = graph.id, .edge = edge_from_last_node, .prev_link = &subinstance});
+			add_extension(new_code, graph.edge(last_node, candidate));
 		}
 	}
 }
 
 /*
-Adds candidate forwards edges extending from the rightmost vertex.
+Finds candidate forwards edges extending from the rightmost vertex.
 */
-void extend_forwards_from_rightmost_vertex(const dfs_projection_link& subinstance,
-                                           const projection_view& instance_view,
-                                           const compact_graph_t& graph,
+template <class view_t, class local_id_t, class add_extension_t>
+void extend_forwards_from_rightmost_vertex(const view_t& instance_view,
+                                           const basic_compact_graph_t<local_id_t>& graph,
                                            const std::span<const dfs_edge_t> dfs_code_list,
                                            const std::span<const edge_id_t> rightmost_path,
-                                           extension_map& map)
+                                           std::vector<adjacency_index_t>& candidate_scratch,
+                                           add_extension_t& add_extension)
 {
 	const auto& last_edge = instance_view.get_edge(rightmost_path[0]);
-	const auto& last_node = graph.vertices[last_edge.to];
+	const auto last_node = last_edge.to;
+	const auto last_node_label = graph.vertex_labels[last_node];
 	const auto min_label = dfs_code_list[0].from_label;
 	const auto to_id = dfs_code_list[rightmost_path[0]].to;
 
-	for (const auto& candidate_edge : last_node.edges)
+	// Pre-pruning: Don't consider vertices if the label is smaller than the current known
+	// label. Also don't consider vertices that have already been added.
+	for (const auto candidate :
+	     admissible_candidates(graph, graph.offsets[last_node], graph.offsets[last_node + 1u],
+	                           min_label, candidate_scratch))
 	{
-		const auto& to_node = graph.vertices[candidate_edge.to];
-
-		// Pre-pruning: Don't consider vertices if the label is smaller than the current known
-		// label. Also don't consider vertices that have already been added.
-		if (instance_view.has_vertex(candidate_edge.to) || to_node.label < min_label)
+		if (instance_view.has_vertex(graph.neighbours[candidate]))
 		{
 			continue;
 		}
 
+		const auto to_label = graph.neighbour_labels[candidate];
+
 		const dfs_edge_t new_code{
 			.from = to_id,
 			.to = static_cast<vertex_id_t>(to_id + 1),
-			.from_label = last_node.label,
-			.edge_label = candidate_edge.label,
-			.to_label = to_node.label,
+			.from_label = last_node_label,
+			.edge_label = graph.edge_labels[candidate],
+			.to_label = to_label,
 		};
 
-		map[new_code].push_back(dfs_projection_link{
-			.graph_id = graph.id, .edge = candidate_edge, .prev_link = &subinstance});
+		add_extension(new_code, graph.edge(last_node, candidate));
 	}
 }
 
 /*
-Adds candidate forwards edge extending from the vertices on the rightmost path (other than the
+Finds candidate forwards edges extending from the vertices on the rightmost path (other than the
 rightmost vertex).
 */
-void extend_forwards_from_rightmost_path(const dfs_projection_link& subinstance,
-                                         const projection_view& instance_view,
-                                         const compact_graph_t& graph,
+template <class view_t, class local_id_t, class add_extension_t>
+void extend_forwards_from_rightmost_path(const view_t& instance_view,
+                                         const basic_compact_graph_t<local_id_t>& graph,
                                          const std::span<const dfs_edge_t> dfs_code_list,
                                          const std::span<const edge_id_t> rightmost_path,
-                                         extension_map& map)
+                                         std::vector<adjacency_index_t>& candidate_scratch,
+                                         add_extension_t& add_extension)
 {
 	const auto min_label = dfs_code_list[0].from_label;
 	const auto to_id = dfs_code_list[rightmost_path[0]].to;
@@ -134,71 +185,390 @@ void extend_forwards_from_rightmost_path(const dfs_projection_link& subinstance,
 	for (const auto rmp_index : rightmost_path)
 	{
 		const auto& rmp_edge = instance_view.get_edge(rmp_index);
-		const auto& rmp_edge_from = graph.vertices[rmp_edge.from];
-		const auto& rmp_edge_to = graph.vertices[rmp_edge.to];
-
-		for (const auto& candidate_edge : rmp_edge_from.edges)
+		const auto rmp_from_label = graph.vertex_labels[rmp_edge.from];
+		const auto rmp_to_label = graph.vertex_labels[rmp_edge.to];
+
+		// Pre-pruning: Similar to extensions from RMV.
+		// More pre-pruning: If the new edge would have a lower label than the existing edge
+		// coming from the same vertex, then it could have been added earlier to make a smaller
+		// DFS code.
+		// Similarly, if those labels are equal, the same logic can be applied to the labels at
+		// the nodes those edges connect to. Adjacency lists are sorted by exactly those labels, so
+		// start from the first edge that is not smaller.
+		const auto adjacency_end = graph.offsets[rmp_edge.from + 1u];
+		const auto adjacency_begin = graph.lower_bound(graph.offsets[rmp_edge.from], adjacency_end,
+		                                               rmp_edge.label, rmp_to_label);
+		for (const auto candidate : admissible_candidates(graph, adjacency_begin, adjacency_end,
+		                                                  min_label, candidate_scratch))
 		{
-			const auto& to_node = graph.vertices[candidate_edge.to];
-
-			// Pre-pruning: Similar to extensions from RMV
-			if (instance_view.has_vertex(candidate_edge.to) || to_node.label < min_label)
+			if (instance_view.has_vertex(graph.neighbours[candidate]))
 			{
 				continue;
 			}
 
-			// More pre-pruning: If the new edge would have a lower label than the existing edge
-			// coming from the same vertex, then it could have been added earlier to make a smaller
-			// DFS code.
-			// Similarly, if those labels are equal, the same logic can be applied to the labels at
-			// the nodes those edges connect to.
-			if (lexicographic_leq(rmp_edge.label, candidate_edge.label, rmp_edge_to.label,
-			                      to_node.label))
+			const auto candidate_label = graph.edge_labels[candidate];
+			const auto to_label = graph.neighbour_labels[candidate];
+			assert(lexicographic_leq(rmp_edge.label, candidate_label, rmp_to_label, to_label));
+
+			const auto from_id = dfs_code_list[rmp_index].from;
+
+			const dfs_edge_t new_code{
+				.from = from_id,
+				.to = static_cast<vertex_id_t>(to_id + 1),
+				.from_label = rmp_from_label,
+				.edge_label = candidate_label,
+				.to_label = to_label,
+			};
+
+			add_extension(new_code, graph.edge(rmp_edge.from, candidate));
+		}
+	}
+}
+/*
+Finds every extension of a single instance of a DFS code.
+*/
+template <class view_t, class local_id_t, class add_extension_t>
+void extend_instance(const view_t& instance_view, const basic_compact_graph_t<local_id_t>& graph,
+                     const std::span<const dfs_edge_t> dfs_code_list,
+                     const std::span<const edge_id_t> rightmost_path,
+                     const rightmost_path_lookup& rmp_lookup,
+                     std::vector<adjacency_index_t>& candidate_scratch,
+                     add_extension_t& add_extension)
+{
+	extend_backwards(instance_view, graph, dfs_code_list, rightmost_path, rmp_lookup,
+	                 add_extension);
+
+	extend_forwards_from_rightmost_vertex(instance_view, graph, dfs_code_list, rightmost_path,
+	                                      candidate_scratch, add_extension);
+
+	extend_forwards_from_rightmost_path(instance_view, graph, dfs_code_list, rightmost_path,
+	                                    candidate_scratch, add_extension);
+}
+
+/*
+Finds the 1-edge extensions of the empty pattern, passing each to add_extension along with its
+graph index.
+*/
+template <class local_id_t, class add_extension_t>
+void extend_empty(const std::span<const basic_compact_graph_t<local_id_t>> graphs,
+                  add_extension_t&& add_extension)
+{
+	for (std::size_t graph_index = 0; graph_index < graphs.size(); ++graph_index)
+	{
+		const auto& graph = graphs[graph_index];
+		for (local_id_t vertex{0}; vertex < graph.n_vertices(); ++vertex)
+		{
+			const auto from_label = graph.vertex_labels[vertex];
+			for (const auto candidate : graph.adjacency(vertex))
 			{
-				const auto from_id = dfs_code_list[rmp_index].from;
-
-				const dfs_edge_t new_code{
-					.from = from_id,
-					.to = static_cast<vertex_id_t>(to_id + 1),
-					.from_label = rmp_edge_from.label,
-					.edge_label = candidate_edge.label,
-					.to_label = to_node.label,
+				const auto to_label = graph.neighbour_labels[candidate];
+
+				// A minimal DFS code starts from the smaller label, so the other direction can
+				// never be grown into a minimal code.
+				if (from_label > to_label)
+				{
+					continue;
+				}
+
+				const dfs_edge_t code{
+					.from = 0,
+					.to = 1,
+					.from_label = from_label,
+					.edge_label = graph.edge_labels[candidate],
+					.to_label = to_label,
 				};
-
-				map[new_code].push_back(dfs_projection_link{
-					.graph_id = graph.id, .edge = candidate_edge, .prev_link = &subinstance});
+				add_extension(static_cast<graph_id_t>(graph_index), code,
+				              graph.edge(vertex, candidate));
 			}
 		}
 	}
 }
-} // namespace
 
-extension_map extend(const std::span<const compact_graph_t> graphs,
-                     const std::span<const dfs_edge_t> dfs_code_list,
-                     const std::span<const dfs_projection_link> subinstances,
-                     const std::span<const edge_id_t> rightmost_path)
+/*
+The number of parts to split work into that is worth up to max_parts: one for the calling thread
+and one for each idle thread of the scheduler, if there is one.
+*/
+std::size_t n_parts_for(const std::size_t max_parts, task_scheduler* const scheduler)
 {
-	extension_map map;
+	if (max_parts <= 1 || scheduler == nullptr)
+	{
+		return 1;
+	}
+	return std::min(max_parts, 1 + scheduler->n_idle_threads());
+}
+
+/*
+Extends each of the subinstances on the calling thread.
+*/
+template <class local_id_t>
+basic_extension_map<local_id_t>
+extend_serial(const std::span<const basic_compact_graph_t<local_id_t>> graphs,
+              const std::span<const dfs_edge_t> dfs_code_list,
+              const std::span<const basic_dfs_projection_link<local_id_t>> subinstances,
+              const std::span<const edge_id_t> rightmost_path)
+{
+	basic_extension_map<local_id_t> map;
 
 	const auto n_vertices = std::ranges::count_if(dfs_code_list, &dfs_edge_t::is_forwards) + 1;
 
-	projection_view instance_view{dfs_code_list.size(), static_cast<std::size_t>(n_vertices)};
+	basic_projection_view<local_id_t> instance_view{dfs_code_list.size(),
+	                                                static_cast<std::size_t>(n_vertices)};
+	const rightmost_path_lookup rmp_lookup{dfs_code_list, rightmost_path};
+	std::vector<adjacency_index_t> candidate_scratch;
 
-	for (const auto& subinstance : subinstances)
+	const auto graph_id_of = [subinstances](const std::size_t i)
+	{ return subinstances[i].graph_id; };
+	for_each_graph(
+		subinstances.size(), graph_id_of,
+		[&](const graph_id_t graph_id, const std::size_t first, const std::size_t last)
+		{
+			const auto& graph = graphs[static_cast<std::size_t>(graph_id)];
+			instance_view.start_graph(graph);
+
+			for (const auto& subinstance : subinstances.subspan(first, last - first))
+			{
+				instance_view.build_view(subinstance, dfs_code_list);
+
+				auto add_extension = [&map, &subinstance](const dfs_edge_t& code,
+				                                          const basic_edge_t<local_id_t>& edge)
+				{
+					map[code].push_back(
+						basic_dfs_projection_link<local_id_t>{.graph_id = subinstance.graph_id,
+					                                          .edge = edge,
+					                                          .prev_link = &subinstance});
+				};
+				extend_instance(instance_view, graph, dfs_code_list, rightmost_path, rmp_lookup,
+				                candidate_scratch, add_extension);
+			}
+		});
+
+	return map;
+}
+
+} // namespace
+
+template <class local_id_t>
+basic_extension_map<local_id_t>
+extend(const std::span<const basic_compact_graph_t<local_id_t>> graphs, task_scheduler* scheduler)
+{
+	using link = basic_dfs_projection_link<local_id_t>;
+	using edge_type = basic_edge_t<local_id_t>;
+
+	std::size_t n_entries = 0;
+	for (const auto& graph : graphs)
 	{
-		const auto& graph = graphs[static_cast<std::size_t>(subinstance.graph_id)];
-		instance_view.build_view(subinstance, graph);
+		n_entries += graph.neighbours.size();
+	}
+	// The seeds take a single scan over the database, so are only worth splitting for large ones.
+	constexpr std::size_t min_entries_per_thread = std::size_t{1} << 16;
+	const auto n_parts = n_parts_for(n_entries / min_entries_per_thread, scheduler);
 
-		extend_backwards(subinstance, instance_view, graph, dfs_code_list, rightmost_path, map);
+	if (n_parts <= 1)
+	{
+		basic_extension_map<local_id_t> map;
+		extend_empty(graphs,
+		             [&map](const graph_id_t graph_id, const dfs_edge_t& code,
+		                    const edge_type& edge)
+		             {
+						 map[code].push_back(
+							 link{.graph_id = graph_id, .edge = edge, .prev_link = nullptr});
+					 });
+		return map;
+	}
 
-		extend_forwards_from_rightmost_vertex(subinstance, instance_view, graph, dfs_code_list,
-		                                      rightmost_path, map);
+	// Split the graphs into ranges with roughly equal numbers of adjacency entries.
+	std::vector<std::size_t> boundaries{0};
+	std::size_t n_entries_so_far = 0;
+	for (std::size_t graph_index = 0; graph_index < graphs.size(); ++graph_index)
+	{
+		n_entries_so_far += graphs[graph_index].neighbours.size();
+		if (n_entries_so_far * n_parts >= n_entries * boundaries.size() &&
+		    boundaries.size() < n_parts)
+		{
+			boundaries.push_back(graph_index + 1);
+		}
+	}
+	boundaries.push_back(graphs.size());
 
-		extend_forwards_from_rightmost_path(subinstance, instance_view, graph, dfs_code_list,
-		                                    rightmost_path, map);
+	const auto extend_part = [&graphs, &boundaries](const std::size_t part, auto&& add_extension)
+	{
+		const auto first = boundaries[part];
+		extend_empty(graphs.subspan(first, boundaries[part + 1] - first),
+		             [&add_extension, first](const graph_id_t graph_id, const dfs_edge_t& code,
+		                                     const edge_type& edge)
+		             {
+						 add_extension(static_cast<graph_id_t>(first + graph_id), code, edge);
+					 });
+	};
+
+	// First count the projections of each seed in each range. That gives every seed's exact size,
+	// and where each range's projections start within it.
+	using seed_counts = std::unordered_map<dfs_edge_t, std::size_t, dfs_edge_hash>;
+	std::vector<seed_counts> counts(boundaries.size() - 1);
+	const auto count_part = [&counts, &extend_part](const std::size_t part)
+	{
+		auto& part_counts = counts[part];
+		extend_part(part, [&part_counts](const graph_id_t, const dfs_edge_t& code, const edge_type&)
+		            { ++part_counts[code]; });
+	};
+	scheduler->run_parts(counts.size(), count_part);
+
+	basic_extension_map<local_id_t> map;
+	for (auto& part_counts : counts)
+	{
+		for (auto& [code, count] : part_counts)
+		{
+			auto& projections = map[code];
+			// Turn the count into the offset this range starts at.
+			const auto start = projections.size();
+			projections.resize(start + count);
+			count = start;
+		}
 	}
 
+	// Then fill them in, each range writing only to its own slots. Every vector has its final
+	// size by now, so pointers into them stay valid.
+	const auto fill_part = [&map, &counts, &extend_part](const std::size_t part)
+	{
+		std::unordered_map<dfs_edge_t, link*, dfs_edge_hash> next_slots;
+		for (const auto& [code, start] : counts[part])
+		{
+			next_slots.emplace(code, map.find(code)->second.data() + start);
+		}
+		extend_part(part,
+		            [&next_slots](const graph_id_t graph_id, const dfs_edge_t& code,
+		                          const edge_type& edge)
+		            {
+						*next_slots.find(code)->second++ =
+							link{.graph_id = graph_id, .edge = edge, .prev_link = nullptr};
+					});
+	};
+	scheduler->run_parts(counts.size(), fill_part);
+
 	return map;
 }
 
+template <class local_id_t>
+basic_extension_map<local_id_t>
+extend(const std::span<const basic_compact_graph_t<local_id_t>> graphs,
+       const std::span<const dfs_edge_t> dfs_code_list,
+       const subinstance_span<local_id_t> subinstances,
+       const std::span<const edge_id_t> rightmost_path, task_scheduler* scheduler)
+{
+	const auto n_parts = n_parts_for(subinstances.size() / min_subinstances_per_thread, scheduler);
+	if (n_parts <= 1)
+	{
+		return extend_serial(graphs, dfs_code_list, subinstances, rightmost_path);
+	}
+
+	// Graphs may be split between parts. That only costs each part its own start in the graph,
+	// whereas keeping graphs whole would run a database of one large graph on a single thread.
+	std::vector<std::size_t> boundaries;
+	for (std::size_t part = 0; part <= n_parts; ++part)
+	{
+		boundaries.push_back(subinstances.size() * part / n_parts);
+	}
+	std::vector<basic_extension_map<local_id_t>> partial_maps(boundaries.size() - 1);
+	const auto extend_part = [&](const std::size_t part)
+	{
+		partial_maps[part] =
+			extend_serial(graphs, dfs_code_list,
+		                  subinstances.subspan(boundaries[part],
+		                                       boundaries[part + 1] - boundaries[part]),
+		                  rightmost_path);
+	};
+	scheduler->run_parts(partial_maps.size(), extend_part);
+
+	// Concatenate in the order of the parts, so that each code's projections are in the same
+	// order (grouped by graph) as if they had been found serially.
+	auto map = std::move(partial_maps[0]);
+	for (auto& partial_map : partial_maps | std::views::drop(1))
+	{
+		for (auto& [code, projections] : partial_map)
+		{
+			auto& merged = map[code];
+			if (merged.empty())
+			{
+				merged = std::move(projections);
+			}
+			else
+			{
+				merged.insert(merged.end(), projections.begin(), projections.end());
+			}
+		}
+	}
+	return map;
+}
+
+template <class local_id_t>
+basic_embedding_extension_map<local_id_t>
+extend_embeddings(const std::span<const basic_compact_graph_t<local_id_t>> graphs)
+{
+	basic_embedding_extension_map<local_id_t> map;
+	extend_empty(graphs,
+	             [&map](const graph_id_t graph_id, const dfs_edge_t& code,
+	                    const basic_edge_t<local_id_t>& edge)
+	             { map[code].push_back(graph_id, edge.from, edge.to, edge.id); });
+	return map;
+}
+
+template <class local_id_t>
+basic_embedding_extension_map<local_id_t>
+extend_embeddings(const std::span<const basic_compact_graph_t<local_id_t>> graphs,
+                  const std::span<const dfs_edge_t> dfs_code_list,
+                  const basic_embedding_list<local_id_t>& embeddings,
+                  const std::span<const edge_id_t> rightmost_path)
+{
+	basic_embedding_extension_map<local_id_t> map;
+
+	const rightmost_path_lookup rmp_lookup{dfs_code_list, rightmost_path};
+	std::vector<adjacency_index_t> candidate_scratch;
+
+	const auto graph_id_of = [&embeddings](const std::size_t row)
+	{ return embeddings.graph_id(row); };
+	for_each_graph(
+		embeddings.size(), graph_id_of,
+		[&](const graph_id_t graph_id, const std::size_t first, const std::size_t last)
+		{
+			const auto& graph = graphs[static_cast<std::size_t>(graph_id)];
+
+			for (auto row = first; row < last; ++row)
+			{
+				const basic_embedding_view instance_view{embeddings, row, dfs_code_list};
+
+				auto add_extension = [&map, &embeddings, row](const dfs_edge_t& code,
+				                                              const basic_edge_t<local_id_t>& edge)
+				{
+					map[code].push_back(embeddings, row, edge.id,
+					                    code.is_forwards()
+					                        ? edge.to
+					                        : basic_embedding_list<local_id_t>::no_vertex);
+				};
+				extend_instance(instance_view, graph, dfs_code_list, rightmost_path, rmp_lookup,
+				                candidate_scratch, add_extension);
+			}
+		});
+
+	return map;
+}
+
+#define SPANG_INSTANTIATE_EXTEND(local_id_t)                                                       \
+	template basic_extension_map<local_id_t> extend(                                               \
+		std::span<const basic_compact_graph_t<local_id_t>>, task_scheduler*);                      \
+	template basic_extension_map<local_id_t> extend(                                               \
+		std::span<const basic_compact_graph_t<local_id_t>>, std::span<const dfs_edge_t>,           \
+		std::span<const basic_dfs_projection_link<local_id_t>>, std::span<const edge_id_t>,        \
+		task_scheduler*);                                                                          \
+	template basic_embedding_extension_map<local_id_t> extend_embeddings(                          \
+		std::span<const basic_compact_graph_t<local_id_t>>);                                       \
+	template basic_embedding_extension_map<local_id_t> extend_embeddings(                          \
+		std::span<const basic_compact_graph_t<local_id_t>>, std::span<const dfs_edge_t>,           \
+		const basic_embedding_list<local_id_t>&, std::span<const edge_id_t>);
+
+SPANG_INSTANTIATE_EXTEND(std::uint8_t)
+SPANG_INSTANTIATE_EXTEND(std::uint16_t)
+SPANG_INSTANTIATE_EXTEND(std::uint32_t)
+
+#undef SPANG_INSTANTIATE_EXTEND
+
 } // namespace spang
@@ -0,0 +1,298 @@
+#include <spang/extend.hpp>
+#include <spang/incremental.hpp>
+#include <spang/is_min.hpp>
+#include <spang/logger.hpp>
+#include <spang/parser.hpp>
+#include <spang/projection.hpp>
+#include <spang/seeded.hpp>
+#include <spang/support.hpp>
+
+#include <algorithm>
+#include <cassert>
+#include <cstdint>
+#include <optional>
+#include <unordered_set>
+#include <utility>
+#include <variant>
+
+namespace spang
+{
+
+namespace
+{
+
+//! The old graphs a pattern occurs in, as indexes into the old graphs, in increasing order.
+using old_support_t = std::vector<std::size_t>;
+
+template <class local_id_t>
+struct incremental_context
+{
+	std::span<const basic_compact_graph_t<local_id_t>> old_graphs;
+	std::span<const basic_compact_graph_t<local_id_t>> new_graphs;
+	const previous_results& previous;
+	std::size_t min_freq;
+	report_level level;
+	report_sink& sink;
+	//! The index of each old graph, by input ID.
+	std::unordered_map<graph_id_t, std::size_t> old_indexes;
+	//! The previous patterns the search has reached, and so reported with their new support.
+	std::unordered_set<const std::vector<dfs_edge_t>*> reached;
+};
+
+/*!
+The old support of the pattern given by codes, if it is one of the previous results, marking it as
+reached.
+*/
+template <class local_id_t>
+auto previous_support(incremental_context<local_id_t>& context,
+                      const std::vector<dfs_edge_t>& codes) -> std::optional<old_support_t>
+{
+	const auto found = context.previous.find(codes);
+	if (found == context.previous.end())
+	{
+		return std::nullopt;
+	}
+	context.reached.insert(&found->first);
+
+	old_support_t support;
+	support.reserve(found->second.size());
+	for (const auto graph_id : found->second)
+	{
+		const auto index = context.old_indexes.find(graph_id);
+		if (index == context.old_indexes.end())
+			log_error("the previous results refer to graph ", graph_id,
+			          ", which is not among the old graphs");
+
+		support.push_back(index->second);
+	}
+	std::ranges::sort(support);
+	return support;
+}
+
+/*!
+The old graphs each 1-edge pattern that could start a minimal DFS code occurs in. Only needed for
+1-edge patterns that were not frequent in the old graphs, which have no parent to narrow them down.
+*/
+template <class local_id_t>
+auto one_edge_supports(const std::span<const basic_compact_graph_t<local_id_t>> old_graphs)
+	-> std::unordered_map<dfs_edge_t, old_support_t, dfs_edge_hash>
+{
+	std::unordered_map<dfs_edge_t, old_support_t, dfs_edge_hash> supports;
+	for (std::size_t index = 0; index < old_graphs.size(); ++index)
+	{
+		const auto& graph = old_graphs[index];
+		for (local_id_t vertex{0}; vertex < graph.n_vertices(); ++vertex)
+		{
+			const auto from_label = graph.vertex_labels[vertex];
+			for (const auto candidate : graph.adjacency(vertex))
+			{
+				if (from_label > graph.neighbour_labels[candidate])
+				{
+					continue;
+				}
+				const dfs_edge_t code{
+					.from = 0,
+					.to = 1,
+					.from_label = from_label,
+					.edge_label = graph.edge_labels[candidate],
+					.to_label = graph.neighbour_labels[candidate],
+				};
+				auto& support = supports[code];
+				if (support.empty() || support.back() != index)
+				{
+					support.push_back(index);
+				}
+			}
+		}
+	}
+	return supports;
+}
+
+template <class local_id_t>
+void report_combined(const incremental_context<local_id_t>& context,
+                     const std::span<const dfs_edge_t> codes, const old_support_t& old_support,
+                     const std::span<const basic_dfs_projection_link<local_id_t>> projections,
+                     const std::size_t new_support)
+{
+	std::vector<graph_id_t> graph_ids;
+	if (context.level == report_level::graph_ids)
+	{
+		for (const auto index : old_support)
+		{
+			graph_ids.push_back(context.old_graphs[index].id);
+		}
+		for (std::size_t i = 0; i < projections.size(); ++i)
+		{
+			if (i == 0 || projections[i].graph_id != projections[i - 1].graph_id)
+			{
+				graph_ids.push_back(
+					context.new_graphs[static_cast<std::size_t>(projections[i].graph_id)].id);
+			}
+		}
+		std::ranges::sort(graph_ids);
+	}
+	report(codes, old_support.size() + new_support, graph_ids, context.level, context.sink);
+}
+
+// codes is inout so we can add to the end of it. projections are in the new graphs only.
+template <class local_id_t>
+void mine_incremental_recurse(
+	incremental_context<local_id_t>& context, std::vector<dfs_edge_t>& codes,
+	const std::span<const edge_id_t> rightmost_path,
+	const std::span<const basic_dfs_projection_link<local_id_t>> projections,
+	const old_support_t& old_support, const std::size_t new_support)
+{
+	report_combined(context, codes, old_support, projections, new_support);
+
+	const auto extensions = extend(context.new_graphs, codes, projections, rightmost_path);
+	for (const auto& [code, code_projections] : extensions)
+	{
+		// A child can only be in the old graphs its parent is in, so this bounds its support
+		// before any old graph is looked at.
+		const auto child_new_support = count_graph_support<local_id_t>(code_projections);
+		if (old_support.size() + child_new_support < context.min_freq)
+		{
+			continue;
+		}
+
+		codes.push_back(code);
+		if (const auto is_min_result = is_min(codes))
+		{
+			auto child_old_support = previous_support(context, codes);
+			if (!child_old_support)
+			{
+				// Not frequent in the old graphs, so not in the previous results, but it may still
+				// be in enough of them to be frequent now.
+				child_old_support.emplace();
+				for (const auto index : old_support)
+				{
+					if (has_embedding(context.old_graphs[index], codes))
+					{
+						child_old_support->push_back(index);
+					}
+				}
+			}
+
+			if (child_old_support->size() + child_new_support >= context.min_freq)
+			{
+				mine_incremental_recurse<local_id_t>(context, codes, is_min_result->first,
+				                                     code_projections, *child_old_support,
+				                                     child_new_support);
+			}
+		}
+		codes.pop_back();
+	}
+}
+
+} // namespace
+
+auto read_previous_results(const std::filesystem::path& path) -> previous_results
+{
+	previous_results results;
+	read_output_file(path,
+	                 [&results](parsed_output_graph_t&& pattern)
+	                 {
+						 if (pattern.support.size() != pattern.support_count)
+							 log_error("pattern ", pattern.id,
+				                       " of the previous results does not list the graphs it is ",
+				                       "in, as written at the graph_ids report level");
+
+						 std::ranges::sort(pattern.support);
+						 results.emplace(canonical_code(pattern), std::move(pattern.support));
+					 });
+	return results;
+}
+
+template <class local_id_t>
+void mine_incremental(const std::span<const basic_compact_graph_t<local_id_t>> old_graphs,
+                      const std::span<const basic_compact_graph_t<local_id_t>> new_graphs,
+                      const previous_results& previous, const std::size_t min_freq,
+                      const report_level level, report_sink& sink)
+{
+	incremental_context<local_id_t> context{
+		.old_graphs = old_graphs,
+		.new_graphs = new_graphs,
+		.previous = previous,
+		.min_freq = min_freq,
+		.level = level,
+		.sink = sink,
+		.old_indexes = {},
+		.reached = {},
+	};
+	for (std::size_t index = 0; index < old_graphs.size(); ++index)
+	{
+		context.old_indexes.emplace(old_graphs[index].id, index);
+	}
+
+	// Only built if a 1-edge pattern that was not frequent before turns up in the new graphs.
+	std::optional<std::unordered_map<dfs_edge_t, old_support_t, dfs_edge_hash>> old_one_edges;
+
+	const auto seeds = extend(new_graphs);
+	for (const auto& [code, projections] : seeds)
+	{
+		std::vector<dfs_edge_t> codes{code};
+		const auto new_support = count_graph_support<local_id_t>(projections);
+
+		auto old_support = previous_support(context, codes);
+		if (!old_support)
+		{
+			if (!old_one_edges)
+			{
+				old_one_edges = one_edge_supports(old_graphs);
+			}
+			const auto found = old_one_edges->find(code);
+			old_support = found == old_one_edges->end() ? old_support_t{} : found->second;
+		}
+
+		if (old_support->size() + new_support < min_freq)
+		{
+			continue;
+		}
+		const auto is_min_result = is_min(codes);
+		assert(is_min_result);
+		mine_incremental_recurse<local_id_t>(context, codes, is_min_result->first, projections,
+		                                     *old_support, new_support);
+	}
+
+	// Every pattern that occurs in a new graph has been reached, so the rest keep the support they
+	// had.
+	for (const auto& [codes, graph_ids] : previous)
+	{
+		if (!context.reached.contains(&codes))
+		{
+			report(codes, graph_ids.size(), graph_ids, level, sink);
+		}
+	}
+}
+
+void mine_incremental(const any_graph_database& graphs, const std::size_t n_old_graphs,
+                      const previous_results& previous, const std::size_t min_freq,
+                      const report_level level, report_sink& sink)
+{
+	std::visit(
+		[&](const auto& database)
+		{
+			if (n_old_graphs > database.size())
+				log_error("there are only ", database.size(), " graphs, but ", n_old_graphs,
+			              " should be old");
+
+			const std::span all{database.data(), database.size()};
+			mine_incremental(all.first(n_old_graphs), all.subspan(n_old_graphs), previous,
+			                 min_freq, level, sink);
+		},
+		graphs);
+}
+
+#define SPANG_INSTANTIATE_INCREMENTAL(local_id_t)                                                  \
+	template void mine_incremental(std::span<const basic_compact_graph_t<local_id_t>>,             \
+	                               std::span<const basic_compact_graph_t<local_id_t>>,             \
+	                               const previous_results&, std::size_t, report_level,             \
+	                               report_sink&);
+
+SPANG_INSTANTIATE_INCREMENTAL(std::uint8_t)
+SPANG_INSTANTIATE_INCREMENTAL(std::uint16_t)
+SPANG_INSTANTIATE_INCREMENTAL(std::uint32_t)
+
+#undef SPANG_INSTANTIATE_INCREMENTAL
+
+} // namespace spang
@@ -7,7 +7,6 @@
 #include <cassert>
 #include <limits>
 #include <optional>
-#include <ranges>
 #include <span>
 #include <vector>
 
@@ -116,35 +115,27 @@ Returns true if there are any possible backwards expansions from the rightmost v
 bool exists_backwards(const std::span<const min_dfs_projection_link> min_instances,
                       const std::size_t instance_start_index, const std::size_t instance_end_index,
                       projection_view& instance_view, const graph_t& min_graph,
-                      const std::span<const edge_id_t> rightmost_path)
+                      const std::span<const edge_id_t> rightmost_path,
+                      const std::span<const dfs_edge_t> dfs_code_list)
 {
+	// The instances are of every code but the last, which is being verified
+	const auto instance_codes = dfs_code_list.first(dfs_code_list.size() - 1);
+	const rightmost_path_lookup rmp_lookup{instance_codes, rightmost_path};
+
 	for (auto instance_index = instance_start_index; instance_index < instance_end_index;
 	     ++instance_index)
 	{
-		instance_view.build_min_view_no_has_vertex_info(min_graph, min_instances, instance_index);
+		instance_view.build_min_view_no_has_vertex_info(min_instances, instance_index,
+		                                                instance_codes);
 
 		const auto& last_edge = instance_view.get_edge(rightmost_path[0]);
 		const auto& last_node = min_graph.vertices[last_edge.to];
 
 		const auto is_available_backwards_edge = [&](const edge_t& edge)
 		{
-			if (instance_view.has_edge(edge.id))
-			{
-				return false;
-			}
-
-			// Similar check to is_backwards_min
-			const auto rmp_candidate_edges = rightmost_path | std::views::drop(1);
-
-			const auto rmp_edge_index =
-				std::ranges::find_if(rmp_candidate_edges,
-			                         [&instance_view, &edge](const auto edge_index)
-			                         {
-										 const auto& rmp_edge = instance_view.get_edge(edge_index);
-										 return edge.to == rmp_edge.from;
-									 });
-
-			return rmp_edge_index != rmp_candidate_edges.end();
+			return !instance_view.has_edge(edge.id) &&
+			       rmp_lookup.backwards_target(instance_view, edge.to) !=
+			           rightmost_path_lookup::no_edge;
 		};
 
 		if (std::ranges::any_of(last_node.edges, is_available_backwards_edge))
@@ -177,10 +168,14 @@ bool is_backwards_min(std::vector<min_dfs_projection_link>& min_instances,
                       const std::span<const edge_id_t> rightmost_path,
                       const std::span<const dfs_edge_t> dfs_code_list)
 {
+	const auto instance_codes = dfs_code_list.first(dfs_code_list.size() - 1);
+	const rightmost_path_lookup rmp_lookup{instance_codes, rightmost_path};
+
 	for (auto instance_index = instance_start_index; instance_index < instance_end_index;
 	     ++instance_index)
 	{
-		instance_view.build_min_view_no_has_vertex_info(min_graph, min_instances, instance_index);
+		instance_view.build_min_view_no_has_vertex_info(min_instances, instance_index,
+		                                                instance_codes);
 
 		const auto& last_edge = instance_view.get_edge(rightmost_path[0]);
 		const auto& last_node = min_graph.vertices[last_edge.to];
@@ -194,19 +189,10 @@ bool is_backwards_min(std::vector<min_dfs_projection_link>& min_instances,
 			}
 
 			// Check which RMP vertex this connects to.
-			// We are checking the from fields of each edge, so skip the first one
-			// since that's where the RMV came from.
-			const auto rmp_candidate_edges = rightmost_path | std::views::drop(1);
-
-			const auto rmp_edge_index =
-				std::ranges::find_if(rmp_candidate_edges,
-			                         [&instance_view, &edge_from_last_node](const auto edge_index)
-			                         {
-										 const auto& rmp_edge = instance_view.get_edge(edge_index);
-										 return edge_from_last_node.to == rmp_edge.from;
-									 });
-
-			if (rmp_edge_index == rmp_candidate_edges.end())
+			const auto rmp_index =
+				rmp_lookup.backwards_target(instance_view, edge_from_last_node.to);
+
+			if (rmp_index == rightmost_path_lookup::no_edge)
 			{
 				// Doesn't connect to any RMP vertex, skip
 				// Minor todo: Maybe if we build vertex info, this can be checked earlier by
@@ -215,12 +201,12 @@ bool is_backwards_min(std::vector<min_dfs_projection_link>& min_instances,
 				continue;
 			}
 
-			const auto& rmp_edge = instance_view.get_edge(*rmp_edge_index);
+			const auto& rmp_edge = instance_view.get_edge(rmp_index);
 			const auto& to_node = min_graph.vertices[rmp_edge.from];
 
 			const dfs_edge_t new_code{
 				.from = dfs_code_list[rightmost_path[0]].to,
-				.to = dfs_code_list[*rmp_edge_index].from,
+				.to = dfs_code_list[rmp_index].from,
 				.from_label = last_node.label,
 				.edge_label = edge_from_last_node.label,
 				.to_label = to_node.label,
@@ -279,7 +265,8 @@ bool is_forwards_min(std::vector<min_dfs_projection_link>& min_instances,
 	for (auto instance_index = instance_start_index; instance_index < instance_end_index;
 	     ++instance_index)
 	{
-		instance_view.build_min_view_no_has_edge_info(min_graph, min_instances, instance_index);
+		instance_view.build_min_view_no_has_edge_info(
+			min_instances, instance_index, dfs_code_list.first(dfs_code_list.size() - 1));
 
 		const auto check_extensions = [&](const vertex_t& rmp_node, const vertex_id_t node_id)
 		{
@@ -379,8 +366,213 @@ void update_rightmost_path(std::vector<edge_id_t>& rightmost_path,
 	}
 }
 
+/*!
+Tracks the smallest candidate extension found so far, and the instances that produce it. The new
+instances are added to the end of the instance list, replacing any of a larger candidate, so spans
+of the list must not be held while adding to it.
+*/
+class min_extension
+{
+  public:
+	min_extension(std::vector<min_dfs_projection_link>& min_instances)
+		: instances{min_instances}, n_old_instances{min_instances.size()}
+	{
+	}
+
+	//! Considers the extension of the given instance by the given edge, with the given code.
+	template <class less_than_t>
+	void add(const dfs_edge_t& new_code, const edge_t& edge, const std::size_t instance_index,
+	         less_than_t less_than)
+	{
+		if (!best || less_than(new_code, *best))
+		{
+			best = new_code;
+			while (instances.size() > n_old_instances)
+			{
+				instances.pop_back();
+			}
+		}
+		if (new_code == *best)
+		{
+			instances.push_back(
+				min_dfs_projection_link{.edge = edge, .prev_link_index = instance_index});
+		}
+	}
+
+	[[nodiscard]] const std::optional<dfs_edge_t>& code() const { return best; }
+
+  private:
+	std::vector<min_dfs_projection_link>& instances;
+	std::size_t n_old_instances;
+	std::optional<dfs_edge_t> best;
+};
+
+/*!
+Finds the smallest backwards extension of the instances of dfs_code_list, if any.
+*/
+void min_backwards_extension(min_extension& extension,
+                             const std::vector<min_dfs_projection_link>& min_instances,
+                             const std::size_t instance_start_index,
+                             const std::size_t instance_end_index, projection_view& instance_view,
+                             const graph_t& graph, const std::span<const edge_id_t> rightmost_path,
+                             const std::span<const dfs_edge_t> dfs_code_list)
+{
+	const rightmost_path_lookup rmp_lookup{dfs_code_list, rightmost_path};
+	const auto rightmost_vertex = dfs_code_list[rightmost_path[0]].to;
+
+	for (auto instance_index = instance_start_index; instance_index < instance_end_index;
+	     ++instance_index)
+	{
+		instance_view.build_min_view_no_has_vertex_info(min_instances, instance_index,
+		                                                dfs_code_list);
+
+		const auto& last_node = graph.vertices[instance_view.get_edge(rightmost_path[0]).to];
+		for (const auto& edge : last_node.edges)
+		{
+			if (instance_view.has_edge(edge.id))
+			{
+				continue;
+			}
+
+			const auto rmp_index = rmp_lookup.backwards_target(instance_view, edge.to);
+			if (rmp_index == rightmost_path_lookup::no_edge)
+			{
+				continue;
+			}
+
+			const dfs_edge_t new_code{
+				.from = rightmost_vertex,
+				.to = dfs_code_list[rmp_index].from,
+				.from_label = last_node.label,
+				.edge_label = edge.label,
+				.to_label = graph.vertices[edge.to].label,
+			};
+			extension.add(new_code, edge, instance_index, backwards_less_than);
+		}
+	}
+}
+
+/*!
+Finds the smallest forwards extension of the instances of dfs_code_list, if any.
+*/
+void min_forwards_extension(min_extension& extension,
+                            const std::vector<min_dfs_projection_link>& min_instances,
+                            const std::size_t instance_start_index,
+                            const std::size_t instance_end_index, projection_view& instance_view,
+                            const graph_t& graph, const std::span<const edge_id_t> rightmost_path,
+                            const std::span<const dfs_edge_t> dfs_code_list)
+{
+	const auto new_vertex = static_cast<vertex_id_t>(dfs_code_list[rightmost_path[0]].to + 1);
+
+	for (auto instance_index = instance_start_index; instance_index < instance_end_index;
+	     ++instance_index)
+	{
+		instance_view.build_min_view_no_has_edge_info(min_instances, instance_index,
+		                                              dfs_code_list);
+
+		const auto add_extensions = [&](const vertex_t& rmp_node, const vertex_id_t node_id)
+		{
+			for (const auto& edge : rmp_node.edges)
+			{
+				if (instance_view.has_vertex(edge.to))
+				{
+					continue;
+				}
+
+				const dfs_edge_t new_code{
+					.from = node_id,
+					.to = new_vertex,
+					.from_label = rmp_node.label,
+					.edge_label = edge.label,
+					.to_label = graph.vertices[edge.to].label,
+				};
+				extension.add(new_code, edge, instance_index, forwards_less_than);
+			}
+		};
+
+		// The rightmost vertex, then the rest of the rightmost path.
+		add_extensions(graph.vertices[instance_view.get_edge(rightmost_path[0]).to],
+		               dfs_code_list[rightmost_path[0]].to);
+		for (const auto rmp_edge_index : rightmost_path)
+		{
+			add_extensions(graph.vertices[instance_view.get_edge(rmp_edge_index).from],
+			               dfs_code_list[rmp_edge_index].from);
+		}
+	}
+}
+
 } // namespace
 
+auto min_dfs_code(const graph_t& graph) -> std::vector<dfs_edge_t>
+{
+	std::vector<dfs_edge_t> dfs_code_list;
+	std::vector<min_dfs_projection_link> min_instances;
+
+	{
+		min_extension first_edge{min_instances};
+		for (const auto& vertex : graph.vertices)
+		{
+			for (const auto& edge : vertex.edges)
+			{
+				const auto to_label = graph.vertices[edge.to].label;
+				if (vertex.label > to_label)
+				{
+					continue;
+				}
+
+				const dfs_edge_t new_code{
+					.from = 0,
+					.to = 1,
+					.from_label = vertex.label,
+					.edge_label = edge.label,
+					.to_label = to_label,
+				};
+				first_edge.add(new_code, edge, min_dfs_projection_link::no_link, first_less_than);
+			}
+		}
+		if (!first_edge.code())
+		{
+			return dfs_code_list;
+		}
+		dfs_code_list.push_back(*first_edge.code());
+	}
+
+	std::vector<edge_id_t> rightmost_path{0};
+	std::size_t instance_start_index = 0;
+	projection_view instance_view(graph.n_edges, graph.vertices.size());
+
+	// As in gSpan, backwards extensions are all smaller than forwards ones, so are only looked at
+	// first.
+	while (dfs_code_list.size() < graph.n_edges)
+	{
+		const auto instance_end_index = min_instances.size();
+		min_extension extension{min_instances};
+		min_backwards_extension(extension, min_instances, instance_start_index,
+		                        instance_end_index, instance_view, graph, rightmost_path,
+		                        dfs_code_list);
+		if (!extension.code())
+		{
+			min_forwards_extension(extension, min_instances, instance_start_index,
+			                       instance_end_index, instance_view, graph, rightmost_path,
+			                       dfs_code_list);
+		}
+		if (!extension.code())
+		{
+			// The graph is not connected.
+			break;
+		}
+
+		dfs_code_list.push_back(*extension.code());
+		if (dfs_code_list.back().is_forwards())
+		{
+			update_rightmost_path(rightmost_path, dfs_code_list);
+		}
+		instance_start_index = instance_end_index;
+	}
+
+	return dfs_code_list;
+}
+
 auto is_min(const std::span<const dfs_edge_t> dfs_code_list)
 	-> std::optional<std::pair<std::vector<edge_id_t>, graph_t>>
 {
@@ -423,7 +615,7 @@ auto is_min(const std::span<const dfs_edge_t> dfs_code_list)
 		else
 		{
 			if (exists_backwards(*min_instances, instance_start_index, instance_end_index,
-			                     instance_view, min_graph, rightmost_path) ||
+			                     instance_view, min_graph, rightmost_path, sublist) ||
 			    !is_forwards_min(*min_instances, instance_start_index, instance_end_index,
 			                     instance_view, min_graph, rightmost_path, sublist))
 			{
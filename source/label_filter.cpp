@@ -0,0 +1,245 @@
+#include <spang/label_filter.hpp>
+
+#include <array>
+#include <bit>
+#include <cassert>
+#include <cstdint>
+
+#if defined(__x86_64__) || defined(_M_X64)
+#define SPANG_X86_64
+#include <immintrin.h>
+#if defined(_MSC_VER) && !defined(__clang__)
+#include <intrin.h>
+#endif
+#endif
+
+// GCC and Clang only allow intrinsics in functions compiled for the instruction set they belong
+// to. This keeps the rest of the build at the baseline, MSVC allows them anywhere.
+#if defined(__GNUC__)
+#define SPANG_TARGET(isa) __attribute__((target(isa)))
+#else
+#define SPANG_TARGET(isa)
+#endif
+
+namespace spang
+{
+
+namespace
+{
+
+using adjacency_index_t = compact_graph_t::adjacency_index_t;
+
+static_assert(sizeof(vertex_label_t) == 4 && sizeof(adjacency_index_t) == 4,
+              "The vector kernels assume 32 bit labels and indexes");
+
+using kernel_t = std::size_t (*)(const vertex_label_t* labels, std::size_t n,
+                                 vertex_label_t min_label, adjacency_index_t first,
+                                 adjacency_index_t* out);
+
+std::size_t filter_scalar(const vertex_label_t* labels, const std::size_t n,
+                          const vertex_label_t min_label, const adjacency_index_t first,
+                          adjacency_index_t* out)
+{
+	// Branchless: always write, only keep the entry if it passed. Since count <= i, this never
+	// writes past out[n - 1].
+	std::size_t count = 0;
+	for (std::size_t i = 0; i < n; ++i)
+	{
+		out[count] = first + static_cast<adjacency_index_t>(i);
+		count += labels[i] >= min_label;
+	}
+	return count;
+}
+
+#ifdef SPANG_X86_64
+
+/*
+AVX2 has no compress instruction, so it is done with a permute. For each 8 bit mask of kept lanes,
+this holds the indexes of the kept lanes packed into 4 bit fields, lowest first.
+*/
+constexpr auto make_compress_table()
+{
+	std::array<std::uint32_t, 256> table{};
+	for (std::uint32_t mask = 0; mask < table.size(); ++mask)
+	{
+		std::uint32_t n_kept = 0;
+		for (std::uint32_t lane = 0; lane < 8; ++lane)
+		{
+			if ((mask >> lane) & 1u)
+			{
+				table[mask] |= lane << (4 * n_kept++);
+			}
+		}
+	}
+	return table;
+}
+
+constexpr auto compress_table = make_compress_table();
+
+SPANG_TARGET("avx2")
+std::size_t filter_avx2(const vertex_label_t* labels, const std::size_t n,
+                        const vertex_label_t min_label, const adjacency_index_t first,
+                        adjacency_index_t* out)
+{
+	const auto min_labels = _mm256_set1_epi32(min_label);
+	const auto field_shifts = _mm256_setr_epi32(0, 4, 8, 12, 16, 20, 24, 28);
+	const auto field_mask = _mm256_set1_epi32(0xf);
+	const auto step = _mm256_set1_epi32(8);
+	auto indexes = _mm256_add_epi32(_mm256_set1_epi32(static_cast<int>(first)),
+	                                _mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7));
+
+	// As in the scalar version, count <= i, so whole registers can be stored without padding.
+	std::size_t count = 0;
+	std::size_t i = 0;
+	for (; i + 8 <= n; i += 8)
+	{
+		const auto values = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(labels + i));
+		const auto below = _mm256_cmpgt_epi32(min_labels, values);
+		const auto kept =
+			~static_cast<unsigned>(_mm256_movemask_ps(_mm256_castsi256_ps(below))) & 0xffu;
+
+		const auto fields = _mm256_set1_epi32(static_cast<int>(compress_table[kept]));
+		const auto permutation =
+			_mm256_and_si256(_mm256_srlv_epi32(fields, field_shifts), field_mask);
+		_mm256_storeu_si256(reinterpret_cast<__m256i*>(out + count),
+		                    _mm256_permutevar8x32_epi32(indexes, permutation));
+
+		count += static_cast<std::size_t>(std::popcount(kept));
+		indexes = _mm256_add_epi32(indexes, step);
+	}
+
+	return count + filter_scalar(labels + i, n - i, min_label,
+	                             first + static_cast<adjacency_index_t>(i), out + count);
+}
+
+SPANG_TARGET("avx512f")
+std::size_t filter_avx512(const vertex_label_t* labels, const std::size_t n,
+                          const vertex_label_t min_label, const adjacency_index_t first,
+                          adjacency_index_t* out)
+{
+	const auto min_labels = _mm512_set1_epi32(min_label);
+	const auto step = _mm512_set1_epi32(16);
+	auto indexes = _mm512_add_epi32(
+		_mm512_set1_epi32(static_cast<int>(first)),
+		_mm512_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15));
+
+	std::size_t count = 0;
+	for (std::size_t i = 0; i < n; i += 16)
+	{
+		// The last register is partial, masked loads never touch the lanes outside of it.
+		const auto remaining = n - i;
+		const auto lanes = static_cast<__mmask16>(remaining >= 16 ? 0xffffu
+		                                                          : (1u << remaining) - 1u);
+		const auto values = _mm512_maskz_loadu_epi32(lanes, labels + i);
+		const auto kept = _mm512_mask_cmpge_epi32_mask(lanes, values, min_labels);
+
+		_mm512_mask_compressstoreu_epi32(out + count, kept, indexes);
+
+		count += static_cast<std::size_t>(std::popcount(static_cast<unsigned>(kept)));
+		indexes = _mm512_add_epi32(indexes, step);
+	}
+	return count;
+}
+
+#endif
+
+kernel_t select_kernel(const simd_level level)
+{
+	switch (level)
+	{
+#ifdef SPANG_X86_64
+	case simd_level::avx512:
+		return filter_avx512;
+	case simd_level::avx2:
+		return filter_avx2;
+#endif
+	default:
+		return filter_scalar;
+	}
+}
+
+} // namespace
+
+simd_level detect_simd_level()
+{
+#if defined(SPANG_X86_64) && defined(__GNUC__)
+	__builtin_cpu_init();
+	if (__builtin_cpu_supports("avx512f"))
+	{
+		return simd_level::avx512;
+	}
+	if (__builtin_cpu_supports("avx2"))
+	{
+		return simd_level::avx2;
+	}
+	return simd_level::scalar;
+#elif defined(SPANG_X86_64) && defined(_MSC_VER)
+	// The CPU has to support the instructions, and the OS has to save the registers they use.
+	int info[4];
+	__cpuid(info, 1);
+	const bool os_saves_registers = ((info[2] >> 27) & 1) != 0;
+	if (!os_saves_registers)
+	{
+		return simd_level::scalar;
+	}
+	const auto saved_registers = _xgetbv(0);
+	__cpuidex(info, 7, 0);
+	const bool has_avx2 = ((info[1] >> 5) & 1) != 0;
+	const bool has_avx512 = ((info[1] >> 16) & 1) != 0;
+
+	if (has_avx512 && (saved_registers & 0xe6) == 0xe6)
+	{
+		return simd_level::avx512;
+	}
+	if (has_avx2 && (saved_registers & 0x6) == 0x6)
+	{
+		return simd_level::avx2;
+	}
+	return simd_level::scalar;
+#else
+	return simd_level::scalar;
+#endif
+}
+
+const char* to_string(const simd_level level)
+{
+	switch (level)
+	{
+	case simd_level::avx512:
+		return "avx512";
+	case simd_level::avx2:
+		return "avx2";
+	default:
+		return "scalar";
+	}
+}
+
+std::size_t filter_labels_at_least(const std::span<const vertex_label_t> labels,
+                                   const vertex_label_t min_label,
+                                   const adjacency_index_t first,
+                                   const std::span<adjacency_index_t> out)
+{
+	static const auto supported = detect_simd_level();
+	return filter_labels_at_least(supported, labels, min_label, first, out);
+}
+
+std::size_t filter_labels_at_least(const simd_level level,
+                                   const std::span<const vertex_label_t> labels,
+                                   const vertex_label_t min_label,
+                                   const adjacency_index_t first,
+                                   const std::span<adjacency_index_t> out)
+{
+	static const auto supported = detect_simd_level();
+	assert(out.size() >= labels.size());
+
+	// Most adjacency lists in molecules are shorter than a single register, where the vector
+	// kernels only add the cost of the indirect call.
+	constexpr std::size_t min_vector_length = 8;
+	const auto kernel = labels.size() < min_vector_length
+	                        ? filter_scalar
+	                        : select_kernel(level < supported ? level : supported);
+
+	return kernel(labels.data(), labels.size(), min_label, first, out.data());
+}
+
+} // namespace spang
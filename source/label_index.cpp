@@ -0,0 +1,228 @@
+#include <spang/label_index.hpp>
+#include <spang/utility.hpp>
+
+#include <algorithm>
+#include <numeric>
+#include <variant>
+
+namespace spang
+{
+
+namespace
+{
+
+//! Calls on_graph with each index in a posting list, in increasing order.
+template <class on_graph_t>
+void for_each_graph(const std::span<const std::uint8_t> gaps, on_graph_t on_graph)
+{
+	std::size_t next = 0;
+	for (auto byte = gaps.begin(); byte != gaps.end(); ++next)
+	{
+		// Posting lists are only written by add(), so each varint is whole.
+		next += static_cast<std::size_t>(*decode_varint([&byte] { return *byte++; }));
+		on_graph(next);
+	}
+}
+
+} // namespace
+
+void label_index::posting_list::add(const std::size_t graph)
+{
+	if (size != 0 && last == graph)
+	{
+		return;
+	}
+	write_varint(gaps, size == 0 ? graph : graph - last - 1);
+	last = graph;
+	++size;
+}
+
+std::vector<std::size_t> label_index::posting_list::decode() const
+{
+	std::vector<std::size_t> graphs;
+	graphs.reserve(size);
+	for_each_graph(gaps, [&graphs](const std::size_t graph) { graphs.push_back(graph); });
+	return graphs;
+}
+
+label_index::edge_key::edge_key(const vertex_label_t from, const edge_label_t edge,
+                                const vertex_label_t to)
+	: from_label{std::min(from, to)}, edge_label{edge}, to_label{std::max(from, to)}
+{
+}
+
+std::size_t label_index::edge_key_hash::operator()(const edge_key& key) const
+{
+	std::size_t seed{0};
+	hash_combine(seed, key.from_label);
+	hash_combine(seed, key.edge_label);
+	hash_combine(seed, key.to_label);
+	return seed;
+}
+
+template <class local_id_t>
+label_index::label_index(const std::span<const basic_compact_graph_t<local_id_t>> graphs)
+{
+	count_starts.reserve(graphs.size() + 1);
+	std::vector<vertex_label_t> labels;
+	for (std::size_t index = 0; index < graphs.size(); ++index)
+	{
+		const auto& graph = graphs[index];
+
+		labels.assign(graph.vertex_labels.begin(), graph.vertex_labels.end());
+		std::ranges::sort(labels);
+		for (auto first = labels.begin(); first != labels.end();)
+		{
+			const auto last = std::ranges::find_if(first, labels.end(), [first](const auto label)
+			                                       { return label != *first; });
+			const auto count = static_cast<std::size_t>(last - first);
+			label_counts.emplace_back(*first, count);
+			vertex_totals[*first] += count;
+			vertex_postings[*first].add(index);
+			first = last;
+		}
+		count_starts.push_back(label_counts.size());
+
+		for (local_id_t vertex{0}; vertex < graph.n_vertices(); ++vertex)
+		{
+			const auto from_label = graph.vertex_labels[vertex];
+			for (const auto candidate : graph.adjacency(vertex))
+			{
+				// Each edge is in the adjacency lists of both its vertices, so only add it once.
+				const auto to_label = graph.neighbour_labels[candidate];
+				if (from_label <= to_label)
+				{
+					edge_postings[edge_key{from_label, graph.edge_labels[candidate], to_label}].add(
+						index);
+				}
+			}
+		}
+	}
+}
+
+label_index::label_index(const any_graph_database& graphs)
+	: label_index{std::visit(
+		  [](const auto& database)
+		  { return label_index{std::span{database.data(), database.size()}}; },
+		  graphs)}
+{
+}
+
+std::size_t label_index::vertex_label_count(const vertex_label_t label) const
+{
+	const auto found = vertex_totals.find(label);
+	return found == vertex_totals.end() ? 0 : found->second;
+}
+
+std::size_t label_index::vertex_label_count(const std::size_t graph,
+                                            const vertex_label_t label) const
+{
+	const auto first = label_counts.begin() + static_cast<std::ptrdiff_t>(count_starts[graph]);
+	const auto last = label_counts.begin() + static_cast<std::ptrdiff_t>(count_starts[graph + 1]);
+	const auto found = std::ranges::lower_bound(first, last, label, {},
+	                                            [](const auto& count) { return count.first; });
+	return found != last && found->first == label ? found->second : 0;
+}
+
+std::vector<std::size_t> label_index::graphs_with_vertex_label(const vertex_label_t label) const
+{
+	const auto found = vertex_postings.find(label);
+	return found == vertex_postings.end() ? std::vector<std::size_t>{} : found->second.decode();
+}
+
+std::vector<std::size_t> label_index::graphs_with_edge(const vertex_label_t from_label,
+                                                       const edge_label_t edge_label,
+                                                       const vertex_label_t to_label) const
+{
+	const auto found = edge_postings.find(edge_key{from_label, edge_label, to_label});
+	return found == edge_postings.end() ? std::vector<std::size_t>{} : found->second.decode();
+}
+
+std::vector<std::size_t> label_index::candidates(const std::span<const dfs_edge_t> codes) const
+{
+	std::vector<const posting_list*> lists;
+	for (const auto& code : codes)
+	{
+		const auto found = edge_postings.find(edge_key{code.from_label, code.edge_label,
+		                                               code.to_label});
+		if (found == edge_postings.end())
+		{
+			return {};
+		}
+		if (std::ranges::find(lists, &found->second) == lists.end())
+		{
+			lists.push_back(&found->second);
+		}
+	}
+
+	std::vector<std::size_t> result;
+	if (lists.empty())
+	{
+		result.resize(n_graphs());
+		std::iota(result.begin(), result.end(), std::size_t{0});
+	}
+	else
+	{
+		std::ranges::sort(lists, {}, &posting_list::size);
+		result = lists.front()->decode();
+		std::vector<std::size_t> kept;
+		for (const auto* const list : std::span{lists}.subspan(1))
+		{
+			kept.clear();
+			auto candidate = result.begin();
+			for_each_graph(list->gaps,
+			               [&](const std::size_t graph)
+			               {
+							   while (candidate != result.end() && *candidate < graph)
+							   {
+								   ++candidate;
+							   }
+							   if (candidate != result.end() && *candidate == graph)
+							   {
+								   kept.push_back(graph);
+							   }
+						   });
+			std::swap(result, kept);
+		}
+	}
+
+	// The number of vertices of each label in the pattern. Vertices are numbered in the order the
+	// codes reach them, so each is counted where it first appears.
+	std::unordered_map<vertex_label_t, std::size_t> needed;
+	std::size_t n_vertices = 0;
+	for (const auto& code : codes)
+	{
+		if (code.from >= n_vertices)
+		{
+			++needed[code.from_label];
+			n_vertices = code.from + 1u;
+		}
+		if (code.to >= n_vertices)
+		{
+			++needed[code.to_label];
+			n_vertices = code.to + 1u;
+		}
+	}
+	const auto lacks_labels = [&](const std::size_t graph)
+	{
+		return std::ranges::any_of(needed,
+		                           [&](const auto& label_count)
+		                           {
+									   const auto [label, count] = label_count;
+									   return vertex_label_count(graph, label) < count;
+								   });
+	};
+	std::erase_if(result, lacks_labels);
+	return result;
+}
+
+#define SPANG_INSTANTIATE_LABEL_INDEX(local_id_t)                                                  \
+	template label_index::label_index(std::span<const basic_compact_graph_t<local_id_t>>);
+
+SPANG_INSTANTIATE_LABEL_INDEX(std::uint8_t)
+SPANG_INSTANTIATE_LABEL_INDEX(std::uint16_t)
+SPANG_INSTANTIATE_LABEL_INDEX(std::uint32_t)
+
+#undef SPANG_INSTANTIATE_LABEL_INDEX
+
+} // namespace spang
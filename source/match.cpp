@@ -0,0 +1,330 @@
+#include <spang/label_index.hpp>
+#include <spang/logger.hpp>
+#include <spang/match.hpp>
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <limits>
+#include <thread>
+#include <utility>
+#include <variant>
+
+namespace spang
+{
+
+namespace
+{
+
+//! A vertex of a pattern, in the order they are matched, with what a graph vertex needs to match.
+struct match_step_t
+{
+	vertex_label_t label;
+	std::size_t degree;
+	//! The earlier step whose vertex this one is reached from, and the label of the edge between
+	//! them. Unused by the first step.
+	std::size_t parent;
+	edge_label_t parent_edge_label;
+	//! The rest of the edges to the vertices of earlier steps, as (step, edge label).
+	std::vector<std::pair<std::size_t, edge_label_t>> back_edges;
+};
+
+struct match_plan_t
+{
+	std::vector<match_step_t> steps;
+	std::size_t n_edges;
+};
+
+/*!
+Orders the vertices of the pattern given by codes for matching, as in RI: the first is one with the
+rarest label, preferring higher degrees, and each after it the one with the most edges to vertices
+already ordered, then the highest degree, then the rarest label.
+*/
+auto make_plan(const std::span<const dfs_edge_t> codes, const label_index& index)
+	-> match_plan_t
+{
+	if (codes.empty())
+		log_error("patterns to match must have at least one edge");
+
+	std::size_t n_vertices = 0;
+	for (const auto& code : codes)
+	{
+		n_vertices = std::max<std::size_t>(n_vertices, std::max(code.from, code.to) + 1u);
+	}
+	std::vector<vertex_label_t> labels(n_vertices);
+	std::vector<std::vector<std::pair<std::size_t, edge_label_t>>> adjacency(n_vertices);
+	for (const auto& code : codes)
+	{
+		labels[code.from] = code.from_label;
+		labels[code.to] = code.to_label;
+		adjacency[code.from].emplace_back(code.to, code.edge_label);
+		adjacency[code.to].emplace_back(code.from, code.edge_label);
+	}
+
+	const auto rarity = [&](const std::size_t vertex)
+	{ return index.vertex_label_count(labels[vertex]); };
+
+	constexpr auto unordered = std::numeric_limits<std::size_t>::max();
+	std::vector<std::size_t> step_of(n_vertices, unordered);
+	// The number of edges from each vertex to vertices already ordered.
+	std::vector<std::size_t> links(n_vertices, 0);
+
+	match_plan_t plan{.steps = {}, .n_edges = codes.size()};
+	plan.steps.reserve(n_vertices);
+	const auto better_first = [&](const std::size_t a, const std::size_t b)
+	{
+		if (rarity(a) != rarity(b))
+		{
+			return rarity(a) < rarity(b);
+		}
+		return adjacency[a].size() > adjacency[b].size();
+	};
+	const auto better = [&](const std::size_t a, const std::size_t b)
+	{
+		if (links[a] != links[b])
+		{
+			return links[a] > links[b];
+		}
+		if (adjacency[a].size() != adjacency[b].size())
+		{
+			return adjacency[a].size() > adjacency[b].size();
+		}
+		return rarity(a) < rarity(b);
+	};
+
+	for (std::size_t i = 0; i < n_vertices; ++i)
+	{
+		auto next = unordered;
+		for (std::size_t vertex = 0; vertex < n_vertices; ++vertex)
+		{
+			if (step_of[vertex] != unordered || (i > 0 && links[vertex] == 0))
+			{
+				continue;
+			}
+			if (next == unordered || (i == 0 ? better_first(vertex, next) : better(vertex, next)))
+			{
+				next = vertex;
+			}
+		}
+		if (next == unordered)
+			log_error("patterns to match must be connected");
+
+		auto& step = plan.steps.emplace_back(match_step_t{.label = labels[next],
+		                                                  .degree = adjacency[next].size(),
+		                                                  .parent = unordered,
+		                                                  .parent_edge_label = 0,
+		                                                  .back_edges = {}});
+		for (const auto& [neighbour, edge_label] : adjacency[next])
+		{
+			if (step_of[neighbour] == unordered)
+			{
+				++links[neighbour];
+			}
+			else if (step.parent == unordered)
+			{
+				step.parent = step_of[neighbour];
+				step.parent_edge_label = edge_label;
+			}
+			else
+			{
+				step.back_edges.emplace_back(step_of[neighbour], edge_label);
+			}
+		}
+		step_of[next] = i;
+	}
+	return plan;
+}
+
+/*!
+Matches the vertices of a pattern one at a time in the order of its plan, backtracking when one
+cannot be matched, until the first embedding is found.
+*/
+template <class local_id_t>
+class plan_search
+{
+  public:
+	explicit plan_search(const match_plan_t& plan) : plan_{plan}
+	{
+		vertices.reserve(plan.steps.size());
+	}
+
+	bool run(const basic_compact_graph_t<local_id_t>& graph)
+	{
+		if (graph.n_vertices() < plan_.steps.size() || graph.neighbours.size() < 2 * plan_.n_edges)
+		{
+			return false;
+		}
+
+		graph_ = &graph;
+		const auto& first = plan_.steps.front();
+		for (local_id_t vertex{0}; vertex < graph.n_vertices(); ++vertex)
+		{
+			if (graph.vertex_labels[vertex] == first.label && degree(vertex) >= first.degree)
+			{
+				vertices.assign(1, vertex);
+				if (match(1))
+				{
+					return true;
+				}
+			}
+		}
+		return false;
+	}
+
+  private:
+	[[nodiscard]] std::size_t degree(const local_id_t vertex) const
+	{
+		return graph_->offsets[vertex + 1u] - graph_->offsets[vertex];
+	}
+
+	//! Matches steps[i] onwards, given a match for the ones before it.
+	bool match(const std::size_t i)
+	{
+		if (i == plan_.steps.size())
+		{
+			return true;
+		}
+
+		const auto& step = plan_.steps[i];
+		const auto from = vertices[step.parent];
+		const auto last = graph_->offsets[from + 1u];
+		for (auto index = graph_->lower_bound(graph_->offsets[from], last, step.parent_edge_label,
+		                                      step.label);
+		     index < last && graph_->edge_labels[index] == step.parent_edge_label &&
+		     graph_->neighbour_labels[index] == step.label;
+		     ++index)
+		{
+			const auto vertex = graph_->neighbours[index];
+			if (degree(vertex) < step.degree ||
+			    std::ranges::find(vertices, vertex) != vertices.end() ||
+			    !has_back_edges(step, vertex, graph_->edge_ids[index]))
+			{
+				continue;
+			}
+
+			vertices.push_back(vertex);
+			if (match(i + 1))
+			{
+				return true;
+			}
+			vertices.pop_back();
+		}
+		return false;
+	}
+
+	/*!
+	Whether vertex has the rest of the edges of step to the vertices of earlier steps, besides the
+	one it was reached by. Parallel edges in the pattern need as many distinct edges in the graph.
+	*/
+	bool has_back_edges(const match_step_t& step, const local_id_t vertex,
+	                    const local_id_t parent_edge)
+	{
+		used_edges.assign(1, parent_edge);
+		for (const auto& [earlier, edge_label] : step.back_edges)
+		{
+			const auto target = vertices[earlier];
+			const auto target_label = plan_.steps[earlier].label;
+			const auto last = graph_->offsets[vertex + 1u];
+			bool found = false;
+			for (auto index =
+			         graph_->lower_bound(graph_->offsets[vertex], last, edge_label, target_label);
+			     !found && index < last && graph_->edge_labels[index] == edge_label &&
+			     graph_->neighbour_labels[index] == target_label;
+			     ++index)
+			{
+				if (graph_->neighbours[index] == target &&
+				    std::ranges::find(used_edges, graph_->edge_ids[index]) == used_edges.end())
+				{
+					used_edges.push_back(graph_->edge_ids[index]);
+					found = true;
+				}
+			}
+			if (!found)
+			{
+				return false;
+			}
+		}
+		return true;
+	}
+
+	const match_plan_t& plan_;
+	const basic_compact_graph_t<local_id_t>* graph_ = nullptr;
+
+	//! The graph vertex each step matched so far maps to.
+	std::vector<local_id_t> vertices;
+	//! The graph edges matched to the edges of the step being checked.
+	std::vector<local_id_t> used_edges;
+};
+
+} // namespace
+
+template <class local_id_t>
+auto match_patterns(const std::span<const basic_compact_graph_t<local_id_t>> graphs,
+                    const std::span<const std::vector<dfs_edge_t>> patterns,
+                    const std::size_t n_threads) -> std::vector<std::vector<graph_id_t>>
+{
+	const label_index index{graphs};
+	std::vector<match_plan_t> plans;
+	plans.reserve(patterns.size());
+	for (const auto& codes : patterns)
+	{
+		plans.push_back(make_plan(codes, index));
+	}
+
+	// Each pattern is matched by one thread, which finds its candidates only when it starts on it,
+	// and searches them in order, so each pattern's graphs are in database order.
+	std::vector<std::vector<graph_id_t>> results(patterns.size());
+	std::atomic<std::size_t> next_pattern{0};
+	const auto run_worker = [&]
+	{
+		for (auto pattern = next_pattern++; pattern < patterns.size(); pattern = next_pattern++)
+		{
+			plan_search<local_id_t> search{plans[pattern]};
+			for (const auto graph_index : index.candidates(patterns[pattern]))
+			{
+				if (search.run(graphs[graph_index]))
+				{
+					results[pattern].push_back(graphs[graph_index].id);
+				}
+			}
+		}
+	};
+
+	std::vector<std::thread> helpers;
+	for (std::size_t i = 1; i < std::min(n_threads, patterns.size()); ++i)
+	{
+		helpers.emplace_back(run_worker);
+	}
+	run_worker();
+	for (auto& helper : helpers)
+	{
+		helper.join();
+	}
+	return results;
+}
+
+auto match_patterns(const any_graph_database& graphs,
+                    const std::span<const std::vector<dfs_edge_t>> patterns,
+                    const std::size_t n_threads) -> std::vector<std::vector<graph_id_t>>
+{
+	return std::visit(
+		[&](const auto& database)
+		{
+			return match_patterns(std::span{database.data(), database.size()}, patterns,
+			                      n_threads);
+		},
+		graphs);
+}
+
+#define SPANG_INSTANTIATE_MATCH(local_id_t)                                                        \
+	template auto match_patterns(std::span<const basic_compact_graph_t<local_id_t>>,               \
+	                             std::span<const std::vector<dfs_edge_t>>, std::size_t)            \
+		-> std::vector<std::vector<graph_id_t>>;
+
+SPANG_INSTANTIATE_MATCH(std::uint8_t)
+SPANG_INSTANTIATE_MATCH(std::uint16_t)
+SPANG_INSTANTIATE_MATCH(std::uint32_t)
+
+#undef SPANG_INSTANTIATE_MATCH
+
+} // namespace spang
@@ -2,43 +2,93 @@
 
 #include <spang/extend.hpp>
 #include <spang/is_min.hpp>
+#include <spang/mine.hpp>
 #include <spang/preprocess.hpp>
 #include <spang/projection.hpp>
 #include <spang/report.hpp>
+#include <spang/scheduler.hpp>
+#include <spang/support.hpp>
 
 #include <cassert>
-#include <ranges>
+#include <cstdint>
+#include <limits>
+#include <memory>
 #include <span>
+#include <variant>
+#include <vector>
 
 namespace spang
 {
 
 namespace
 {
-auto count_support(const std::span<const dfs_projection_link>& links) -> std::size_t
+/*!
+The support of the pattern given by codes, counted with the given measure.
+*/
+template <class local_id_t>
+auto count_support(const support_measure measure,
+                   const std::span<const basic_compact_graph_t<local_id_t>> graphs,
+                   const std::span<const dfs_edge_t> codes,
+                   const std::span<const basic_dfs_projection_link<local_id_t>> links)
+	-> std::size_t
 {
 	// Not sure if this is valid, keep for now
 	assert(!links.empty());
-	graph_id_t prev_id = links.front().graph_id;
-	std::size_t support = 0;
-
-	const auto view = links | std::views::drop(1);
-	for (const auto& link : view)
+	if (measure == support_measure::graphs)
 	{
-		if (prev_id != link.graph_id)
-		{
-			prev_id = link.graph_id;
-			++support;
-		}
+		return count_graph_support(links);
 	}
-	return support;
+
+	// The counter's bitsets grow to the size of the largest graph, so each thread keeps one for
+	// every pattern it counts, rather than allocating them again for each node of the search.
+	thread_local basic_mni_counter<local_id_t> mni;
+	return mni.count(graphs, codes, links);
 }
 
-// codes is inout so we can add to the end of it. Might be revisited once we parallelize.
-void mine_recurse(const std::span<const compact_graph_t> graphs,
-                  const std::span<const dfs_projection_link> projections,
-                  std::vector<dfs_edge_t>& codes, const std::size_t codes_support,
-                  const std::size_t min_freq)
+/*!
+Rough estimate of the work needed to mine the subtree below a pattern. Every projection has to be
+extended at each level, and the more graphs a pattern occurs in, the more of its extensions tend to
+be frequent, so the subtree gets both wider and deeper.
+*/
+template <class local_id_t>
+auto estimate_cost(const std::span<const basic_dfs_projection_link<local_id_t>> links,
+                   const std::size_t support) -> std::size_t
+{
+	return links.size() * support;
+}
+
+/*!
+The extensions of a single pattern. Projection links point back into their parent's extensions,
+so these are shared between every subtree (possibly running on other threads) that still needs
+them, and freed once the last of those finishes.
+*/
+template <class local_id_t>
+struct extension_node
+{
+	basic_extension_map<local_id_t> extensions;
+	std::shared_ptr<const extension_node> parent;
+};
+
+template <class local_id_t>
+struct search_context
+{
+	std::span<const basic_compact_graph_t<local_id_t>> graphs;
+	std::size_t min_freq;
+	support_measure measure;
+	report_level level;
+	report_sink& sink;
+	const constraints_t& constraints;
+	task_scheduler& scheduler;
+	//! Subtrees estimated to cost more than this are run as separate tasks.
+	std::size_t split_threshold;
+};
+
+// codes is inout so we can add to the end of it. Tasks split off from here get their own copy.
+template <class local_id_t>
+void mine_recurse(const search_context<local_id_t>& context,
+                  const std::span<const basic_dfs_projection_link<local_id_t>> projections,
+                  const std::shared_ptr<const extension_node<local_id_t>>& projections_owner,
+                  std::vector<dfs_edge_t>& codes, const std::size_t codes_support)
 {
 	// The 1s are already known to be minimal. The check is pretty cheap though, otherwise we need
 	// to check on the looping thread, which could slow things down.
@@ -49,67 +99,163 @@ void mine_recurse(const std::span<const compact_graph_t> graphs,
 	}
 	const auto& [rightmost_path, min_graph] = *is_min_result;
 
-	report(codes, projections, codes_support);
+	const auto& constraints = context.constraints;
+	if (constraints.satisfied_by(codes))
+	{
+		report(context.graphs, codes, projections, codes_support, context.level, context.sink);
+	}
+	if (codes.size() >= constraints.max_edges)
+	{
+		return;
+	}
 
-	const auto extended_projections = extend(graphs, codes, projections, rightmost_path);
+	// Only needed to check the degree limit.
+	std::vector<std::size_t> degrees;
+	if (constraints.max_degree != constraints_t::no_limit)
+	{
+		for (const auto& vertex : min_graph.vertices)
+		{
+			degrees.push_back(vertex.edges.size());
+		}
+	}
 
-	for (const auto& [code, code_projections] : extended_projections)
+	// Near the root a single pattern can have millions of projections, while the other threads
+	// have nothing to do yet, so let them help with the extension.
+	auto node = std::make_shared<extension_node<local_id_t>>(extension_node<local_id_t>{
+		.extensions =
+			extend(context.graphs, codes, projections, rightmost_path, &context.scheduler),
+		.parent = projections_owner,
+	});
+
+	for (const auto& [code, code_projections] : node->extensions)
 	{
 		// Mini todo: Would we get any benefit from freeing the memory of the infrequent codes now?
 		// Also to investigate: Should we do this check here, or is it okay to delay until the
 		// recursive call? Gut feeling says it's cheaper to check here.
-		const auto support = count_support(code_projections);
-		if (support >= min_freq)
+		if (!constraints.allows_extension(degrees, codes.size(), code))
+		{
+			continue;
+		}
+		codes.push_back(code);
+		const auto support =
+			count_support<local_id_t>(context.measure, context.graphs, codes, code_projections);
+		if (support < context.min_freq)
 		{
-			codes.push_back(code);
-			mine_recurse(graphs, code_projections, codes, support, min_freq);
 			codes.pop_back();
+			continue;
+		}
+
+		const auto cost = estimate_cost<local_id_t>(code_projections, support);
+		if (cost > context.split_threshold)
+		{
+			context.scheduler.submit(cost, [&context, &code_projections, node, child_codes = codes,
+			                                support]() mutable
+			                         {
+										 mine_recurse<local_id_t>(context, code_projections, node,
+				                                                  child_codes, support);
+									 });
 		}
+		else
+		{
+			mine_recurse<local_id_t>(context, code_projections, node, codes, support);
+		}
+		codes.pop_back();
 	}
 }
 
 } // namespace
 
-void mine(const std::span<const compact_graph_t> graphs, const std::size_t min_freq)
+template <class local_id_t>
+void mine(const std::span<const basic_compact_graph_t<local_id_t>> graphs,
+          const std::size_t min_freq, const std::size_t n_threads, const support_measure measure,
+          const report_level level, const constraints_t& constraints, report_sink& sink)
 {
-	// Construct the inital 1-graphs and their instances
-	extension_map one_edge_projections;
+	task_scheduler scheduler{n_threads};
+
+	// Construct the inital 1-graphs and their instances. This runs as a task, so that the rest of
+	// the threads can help with it.
+	std::shared_ptr<extension_node<local_id_t>> seeds;
+	scheduler.submit(0,
+	                 [&graphs, &scheduler, &seeds]
+	                 {
+						 seeds = std::make_shared<extension_node<local_id_t>>(
+							 extension_node<local_id_t>{
+								 .extensions = extend(graphs, &scheduler),
+								 .parent = nullptr,
+							 });
+					 });
+	scheduler.run();
+	const auto& one_edge_projections = seeds->extensions;
 
-	for (const auto& graph : graphs)
+	// Aim for a number of tasks well above the number of threads, so that the tail of the search
+	// is made of many small pieces instead of one big one. With a single thread there is nothing to
+	// balance, so never split.
+	constexpr std::size_t tasks_per_thread = 16;
+	std::size_t total_cost = 0;
+	// In the same order as the seeds.
+	std::vector<std::size_t> seed_supports;
+	for (const auto& [code, projections] : one_edge_projections)
 	{
-		for (const auto& vertex : graph.vertices)
-		{
-			for (const auto& edge : vertex.edges)
-			{
-				const dfs_edge_t code{
-					.from = 0,
-					.to = 1,
-					.from_label = vertex.label,
-					.edge_label = edge.label,
-					.to_label = graph.vertices[edge.to].label,
-				};
-				one_edge_projections[code].push_back(dfs_projection_link{
-					.graph_id = graph.id,
-					.edge = edge,
-					.prev_link = nullptr,
-				});
-			}
-		}
+		// Seeds the constraints rule out are skipped below, as having no support.
+		const auto support =
+			constraints.allows_extension({}, 0, code)
+				? count_support<local_id_t>(measure, graphs, std::span{&code, 1}, projections)
+				: 0;
+		seed_supports.push_back(support);
+		total_cost += estimate_cost<local_id_t>(projections, support);
 	}
+	const search_context<local_id_t> context{
+		.graphs = graphs,
+		.min_freq = min_freq,
+		.measure = measure,
+		.level = level,
+		.sink = sink,
+		.constraints = constraints,
+		.scheduler = scheduler,
+		.split_threshold = scheduler.n_threads() == 1
+	                           ? std::numeric_limits<std::size_t>::max()
+	                           : total_cost / (scheduler.n_threads() * tasks_per_thread),
+	};
 
-	// Could maybe do 1-spans instead here? Not sure if this is worth it. Will re-evaluate once we
-	// get parallelism.
-	std::vector<dfs_edge_t> codes;
+	std::size_t seed_index = 0;
 	for (const auto& [code, projections] : one_edge_projections)
 	{
-		// No need to check frequency, we already know these 1-edges are frequent due to the
-		// preprocessing.
-		// Though we might need the support for reporting, later problem.
-		codes.push_back(code);
-		const auto support = count_support(projections);
-		mine_recurse(graphs, projections, codes, support, min_freq);
-		codes.pop_back();
+		// Preprocessing only keeps the 1-edges that are in at least min_freq graphs, but by other
+		// measures some of those may still be infrequent.
+		const auto support = seed_supports[seed_index++];
+		if (support < min_freq || support == 0)
+		{
+			continue;
+		}
+		scheduler.submit(estimate_cost<local_id_t>(projections, support),
+		                 [&context, &code, &projections, &seeds, support]
+		                 {
+							 std::vector<dfs_edge_t> codes{code};
+							 mine_recurse<local_id_t>(context, projections, seeds, codes,
+							                          support);
+						 });
 	}
+
+	scheduler.run();
 }
 
+void mine(const any_graph_database& graphs, const std::size_t min_freq,
+          const std::size_t n_threads, const support_measure measure, const report_level level,
+          const constraints_t& constraints, report_sink& sink)
+{
+	std::visit([min_freq, n_threads, measure, level, &constraints, &sink](const auto& database)
+	           { mine(database, min_freq, n_threads, measure, level, constraints, sink); },
+	           graphs);
+}
+
+template void mine(std::span<const basic_compact_graph_t<std::uint8_t>>, std::size_t,
+                   std::size_t, support_measure, report_level, const constraints_t&,
+                   report_sink&);
+template void mine(std::span<const basic_compact_graph_t<std::uint16_t>>, std::size_t,
+                   std::size_t, support_measure, report_level, const constraints_t&,
+                   report_sink&);
+template void mine(std::span<const basic_compact_graph_t<std::uint32_t>>, std::size_t,
+                   std::size_t, support_measure, report_level, const constraints_t&,
+                   report_sink&);
+
 } // namespace spang
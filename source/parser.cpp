@@ -2,18 +2,38 @@
 #include <spang/logger.hpp>
 #include <spang/parser.hpp>
 
+#include <algorithm>
+#include <atomic>
+#include <charconv>
+#include <fstream>
+#include <functional>
+#include <iterator>
 #include <sstream>
 #include <string>
+#include <string_view>
+#include <system_error>
+#include <thread>
+#include <utility>
+
+#ifndef _WIN32
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
 
 namespace spang
 {
 
-void input_parser::read(std::istream& stream)
+void read_input_graphs(std::istream& stream,
+                       const std::function<void(parsed_input_graph_t&&)>& on_graph)
 {
 	// This overall could be optimized, but currently this implementation
 	// is aimed at simplicity with reasonable error reporting.
 	std::string buffer;
 	std::size_t line_no = 0;
+	parsed_input_graph_t current;
+	bool first = true;
 	while (std::getline(stream, buffer))
 	{
 		std::istringstream line(buffer);
@@ -33,30 +53,39 @@ void input_parser::read(std::istream& stream)
 			if (!(line >> pound && pound == '#' && line >> id))
 				log_error("line ", line_no, ", expected \"t # <id>\"");
 
-			graphs.push_back(parsed_input_graph_t{.id = id, .vertices = {}, .edges = {}});
+			if (first)
+			{
+				first = false;
+			}
+			else
+			{
+				// The previous graph is complete.
+				on_graph(std::move(current));
+			}
+			current = parsed_input_graph_t{.id = id, .vertices = {}, .edges = {}};
 			break;
 		}
 		case 'v':
 		{
-			vertex_id_t id;
+			parsed_vertex_id_t id;
 			vertex_label_t label;
 			if (!(line >> id >> label))
 				log_error("line ", line_no, ", expected \"v <id> <label>\"");
 
-			graphs.back().vertices.push_back(parsed_vertex_t{.id = id, .label = label});
+			current.vertices.push_back(parsed_vertex_t{.id = id, .label = label});
 			break;
 		}
 		case 'e':
 		{
-			vertex_id_t from, to;
+			parsed_vertex_id_t from, to;
 			edge_label_t label;
 			if (!(line >> from >> to >> label))
 				log_error("line ", line_no, ", expected \"e <from_id> <to_id> <label>\"");
 
 			// TODO: Proper error reporting for this
-			assert(graphs.back().vertices.size() > static_cast<std::size_t>(from));
-			assert(graphs.back().vertices.size() > static_cast<std::size_t>(to));
-			graphs.back().edges.push_back(parsed_edge_t{.from = from, .to = to, .label = label});
+			assert(current.vertices.size() > static_cast<std::size_t>(from));
+			assert(current.vertices.size() > static_cast<std::size_t>(to));
+			current.edges.push_back(parsed_edge_t{.from = from, .to = to, .label = label});
 			break;
 		}
 		case '#':
@@ -71,96 +100,324 @@ void input_parser::read(std::istream& stream)
 		}
 		}
 	}
+
+	// Add the last graph, if there were any.
+	if (!first)
+	{
+		on_graph(std::move(current));
+	}
 }
 
-void output_parser::read(std::istream& stream)
+void input_parser::read(std::istream& stream)
 {
-	// This overall could be optimized, but currently this implementation
-	// is aimed at simplicity with reasonable error reporting.
-	std::string buffer;
-	std::size_t line_no = 0;
-	parsed_output_graph_t current;
-	bool first = true;
-	while (std::getline(stream, buffer))
-	{
-		std::istringstream line(buffer);
+	read_input_graphs(stream, [this](parsed_input_graph_t&& graph)
+	                  { graphs.push_back(std::move(graph)); });
+}
 
-		char line_type;
+namespace
+{
 
-		if (!(line >> line_type))
-			// Empty line, ignore.
-			continue;
+/*!
+Reads the fields of one line in place. Fields are separated by spaces, as with operator>>, except
+that single character fields may also be joined to the field after them, as in "x:".
+*/
+class line_reader
+{
+  public:
+	explicit line_reader(const std::string_view line) : rest{line} {}
 
-		switch (line_type)
+	//! Reads the next character, or fails at the end of the line.
+	bool read_char(char& c)
+	{
+		skip_spaces();
+		if (rest.empty())
 		{
-		case 't':
+			return false;
+		}
+		c = rest.front();
+		rest.remove_prefix(1);
+		return true;
+	}
+
+	//! Reads the given character, failing on any other.
+	bool expect(const char expected)
+	{
+		char c;
+		return read_char(c) && c == expected;
+	}
+
+	template <class int_t>
+	bool read_int(int_t& value)
+	{
+		skip_spaces();
+		const auto [end, error] = std::from_chars(rest.data(), rest.data() + rest.size(), value);
+		if (error != std::errc{})
 		{
-			char pound, asterisk;
-			graph_id_t id;
-			std::size_t supp;
-			if (!(line >> pound && pound == '#' && line >> id >> asterisk && asterisk == '*' &&
-			      line >> supp))
-			{
-				log_error("line ", line_no, ", expected \"t # <id> * <support>\"");
-				return;
-			}
+			return false;
+		}
+		rest.remove_prefix(static_cast<std::size_t>(end - rest.data()));
+		return true;
+	}
 
-			if (first)
-			{
-				first = false;
-			}
-			else
-			{
-				// Insert the current graph
-				graphs.emplace(std::move(current));
+  private:
+	void skip_spaces()
+	{
+		const auto first = rest.find_first_not_of(" \t\r");
+		rest.remove_prefix(first == std::string_view::npos ? rest.size() : first);
+	}
 
-				// The moved-from vectors are guaranteed to
-				// be empty(), no need to clear them.
-			}
+	std::string_view rest;
+};
 
-			current.id = id;
-			current.support.reserve(supp);
-			break;
-		}
-		case 'v':
-		{
-			vertex_id_t id;
-			vertex_label_t label;
-			if (!(line >> id >> label))
-				log_error("line ", line_no, ", expected \"v <id> <label>\"");
+/*!
+Builds output graphs a line at a time, passing each to on_graph once it is complete.
+*/
+class output_graph_builder
+{
+  public:
+	explicit output_graph_builder(const std::function<void(parsed_output_graph_t&&)>& on_graph)
+		: on_graph_{on_graph}
+	{
+	}
 
-			current.vertices.push_back(parsed_vertex_t{.id = id, .label = label});
-			break;
+	void add_line(std::string_view text);
+
+	//! Passes on the last graph, if there were any.
+	void finish()
+	{
+		if (!first)
+		{
+			on_graph_(std::move(current));
 		}
-		case 'e':
+	}
+
+  private:
+	const std::function<void(parsed_output_graph_t&&)>& on_graph_;
+	std::size_t line_no = 0;
+	parsed_output_graph_t current;
+	bool first = true;
+};
+
+void output_graph_builder::add_line(const std::string_view text)
+{
+	++line_no;
+	line_reader line{text};
+
+	char line_type;
+	if (!line.read_char(line_type))
+		// Empty line, ignore.
+		return;
+
+	switch (line_type)
+	{
+	case 't':
+	{
+		graph_id_t id;
+		std::size_t supp;
+		if (!(line.expect('#') && line.read_int(id) && line.expect('*') && line.read_int(supp)))
 		{
-			vertex_id_t from, to;
-			edge_label_t label;
-			if (!(line >> from >> to >> label))
-				log_error("line ", line_no, ", expected \"e <from_id> <to_id> <label>\"");
+			log_error("line ", line_no, ", expected \"t # <id> * <support>\"");
+		}
 
-			current.edges.push_back(parsed_edge_t{.from = from, .to = to, .label = label});
-			break;
+		if (first)
+		{
+			first = false;
 		}
-		case 'x':
+		else
 		{
-			char colon;
-			graph_id_t temp;
-			if (!(line >> colon && colon == ':'))
-				log_error("line ", line_no, ", expected \"x: <support list>\"");
-
-			while (line >> temp)
-				current.support.push_back(temp);
-			break;
+			// The previous graph is complete.
+			on_graph_(std::move(current));
 		}
-		default:
-			log_error("invalid token '", line_type, "' on line ", line_no,
-			          ", expected t, v, e, or x.");
+
+		current = parsed_output_graph_t{};
+		current.id = id;
+		current.support_count = supp;
+		current.support.reserve(supp);
+		break;
+	}
+	case 'v':
+	{
+		parsed_vertex_id_t id;
+		vertex_label_t label;
+		if (!(line.read_int(id) && line.read_int(label)))
+			log_error("line ", line_no, ", expected \"v <id> <label>\"");
+
+		current.vertices.push_back(parsed_vertex_t{.id = id, .label = label});
+		break;
+	}
+	case 'e':
+	{
+		parsed_vertex_id_t from, to;
+		edge_label_t label;
+		if (!(line.read_int(from) && line.read_int(to) && line.read_int(label)))
+			log_error("line ", line_no, ", expected \"e <from_id> <to_id> <label>\"");
+
+		current.edges.push_back(parsed_edge_t{.from = from, .to = to, .label = label});
+		break;
+	}
+	case 'x':
+	{
+		graph_id_t temp;
+		if (!line.expect(':'))
+			log_error("line ", line_no, ", expected \"x: <support list>\"");
+
+		while (line.read_int(temp))
+			current.support.push_back(temp);
+		break;
+	}
+	default:
+		log_error("invalid token '", line_type, "' on line ", line_no,
+		          ", expected t, v, e, or x.");
+	}
+}
+
+/*!
+The contents of a file, mapped into memory where possible so that they are never copied, and read
+into a buffer otherwise.
+*/
+class file_contents
+{
+  public:
+	explicit file_contents(const std::filesystem::path& path);
+	~file_contents();
+
+	file_contents(const file_contents&) = delete;
+	file_contents& operator=(const file_contents&) = delete;
+
+	[[nodiscard]] std::string_view text() const { return {data, size}; }
+
+  private:
+	const char* data{nullptr};
+	std::size_t size{0};
+#ifdef _WIN32
+	std::string buffer;
+#endif
+};
+
+#ifdef _WIN32
+
+file_contents::file_contents(const std::filesystem::path& path)
+{
+	std::ifstream file(path, std::ios::binary);
+	if (!file)
+		log_error("could not open ", path);
+
+	buffer.assign(std::istreambuf_iterator<char>{file}, std::istreambuf_iterator<char>{});
+	data = buffer.data();
+	size = buffer.size();
+}
+
+file_contents::~file_contents() = default;
+
+#else
+
+file_contents::file_contents(const std::filesystem::path& path)
+{
+	const int fd = ::open(path.c_str(), O_RDONLY);
+	if (fd < 0)
+		log_error("could not open ", path);
+
+	struct stat info = {};
+	if (::fstat(fd, &info) != 0)
+		log_error("could not read the size of ", path);
+
+	size = static_cast<std::size_t>(info.st_size);
+	// Mapping nothing fails, but there is nothing to read anyway.
+	if (size != 0)
+	{
+		void* const mapped = ::mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+		if (mapped == MAP_FAILED)
+			log_error("could not map ", path);
+
+		::madvise(mapped, size, MADV_SEQUENTIAL);
+		data = static_cast<const char*>(mapped);
+	}
+	::close(fd);
+}
+
+file_contents::~file_contents()
+{
+	if (data != nullptr)
+	{
+		::munmap(const_cast<char*>(data), size);
+	}
+}
+
+#endif
+
+} // namespace
+
+void read_output_graphs(std::istream& stream,
+                        const std::function<void(parsed_output_graph_t&&)>& on_graph)
+{
+	output_graph_builder builder{on_graph};
+	std::string buffer;
+	while (std::getline(stream, buffer))
+	{
+		builder.add_line(buffer);
+	}
+	builder.finish();
+}
+
+void read_output_graphs(std::string_view text,
+                        const std::function<void(parsed_output_graph_t&&)>& on_graph)
+{
+	output_graph_builder builder{on_graph};
+	while (!text.empty())
+	{
+		const auto end = std::min(text.find('\n'), text.size());
+		builder.add_line(text.substr(0, end));
+		text.remove_prefix(std::min(end + 1, text.size()));
+	}
+	builder.finish();
+}
+
+void read_output_file(const std::filesystem::path& path,
+                      const std::function<void(parsed_output_graph_t&&)>& on_graph)
+{
+	const file_contents contents{path};
+	read_output_graphs(contents.text(), on_graph);
+}
+
+void output_parser::read(std::istream& stream)
+{
+	read_output_graphs(stream, [this](parsed_output_graph_t&& graph)
+	                   { graphs.emplace(std::move(graph)); });
+}
+
+void output_parser::read(const std::span<const std::filesystem::path> files,
+                         const std::size_t n_threads)
+{
+	// Each thread reads whole files into its own set, which are merged at the end.
+	std::vector<std::set<parsed_output_graph_t>> thread_graphs(
+		std::max<std::size_t>(std::min(n_threads, files.size()), 1));
+	std::atomic<std::size_t> next_file{0};
+
+	const auto work = [&](std::set<parsed_output_graph_t>& part)
+	{
+		for (auto i = next_file++; i < files.size(); i = next_file++)
+		{
+			read_output_file(files[i], [&part](parsed_output_graph_t&& graph)
+			                 { part.emplace(std::move(graph)); });
 		}
+	};
+
+	std::vector<std::thread> helpers;
+	helpers.reserve(thread_graphs.size() - 1);
+	for (std::size_t i = 1; i < thread_graphs.size(); ++i)
+	{
+		helpers.emplace_back(work, std::ref(thread_graphs[i]));
+	}
+	work(thread_graphs[0]);
+	for (auto& helper : helpers)
+	{
+		helper.join();
 	}
 
-	// Add the last graph.
-	graphs.emplace(std::move(current));
+	for (auto& part : thread_graphs)
+	{
+		graphs.merge(part);
+	}
 }
 
 } // namespace spang
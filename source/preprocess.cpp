@@ -1,11 +1,24 @@
+#include <spang/constraints.hpp>
 #include <spang/graph.hpp>
+#include <spang/logger.hpp>
 #include <spang/preprocess.hpp>
 #include <spang/utility.hpp>
 
 #include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <iterator>
+#include <cstdint>
 #include <limits>
 #include <map>
+#include <mutex>
 #include <set> // IWYU pragma: keep (std::set, incorrect lint)
+#include <span>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <tuple>
 #include <unordered_map>
 #include <unordered_set>
 #include <vector>
@@ -35,39 +48,6 @@ struct prune_infrequent
 	}
 };
 
-/*!
-Searches graphs for each vertex label that occurs in at least min_freq graphs.
-For each frequent label, returns the number of graphs it occurs in.
-*/
-[[nodiscard]] auto find_frequent_vertex_labels(const std::span<const parsed_input_graph_t> graphs,
-                                               std::size_t min_freq)
-	-> std::map<vertex_label_t, occurrence_count>
-{
-	// Start by creating maps containing all labels, then prune infrequent ones
-	// later.
-	std::map<vertex_label_t, occurrence_count> freq_vertex_labels;
-
-	for (const auto& graph : graphs)
-	{
-		// Temporary sets are necessary to ensure each label is counted at most
-		// once per graph.
-		std::set<vertex_label_t> vertex_labels;
-		for (const auto& vertex : graph.vertices)
-		{
-			if (vertex_labels.insert(vertex.label).second)
-			{
-				// Only count the first occurence.
-				++freq_vertex_labels[vertex.label];
-			}
-		}
-	}
-
-	// Prune infrequent labels.
-	std::erase_if(freq_vertex_labels, prune_infrequent{min_freq});
-
-	return freq_vertex_labels;
-}
-
 struct combined_edge_label
 {
 	vertex_label_t from_label, to_label;
@@ -96,85 +76,141 @@ struct combined_edge_label_hash
 	}
 };
 
-[[nodiscard]] auto find_frequent_edge_labels(
-	const std::span<const parsed_input_graph_t> graphs,
-	const std::map<vertex_label_t, occurrence_count>& freq_vertex_labels, std::size_t min_freq)
-	-> std::unordered_map<combined_edge_label, occurrence_count, combined_edge_label_hash>
+using edge_label_counts =
+	std::unordered_map<combined_edge_label, occurrence_count, combined_edge_label_hash>;
+
+//! The labels that occur in at least min_freq graphs, and the number of graphs they occur in.
+struct frequent_labels
 {
-	// Start by creating maps containing all labels, then prune infrequent ones
-	// later.
-	std::unordered_map<combined_edge_label, occurrence_count, combined_edge_label_hash>
-		freq_edge_labels;
+	std::map<vertex_label_t, occurrence_count> vertex_labels;
+	edge_label_counts edge_labels;
+};
 
-	for (const auto& graph : graphs)
+/*!
+Counts the number of graphs each vertex label and edge label occurs in. Graphs are added one at a
+time, so they can be counted as they are read rather than all being held in memory.
+
+Edges are counted regardless of whether their vertex labels are frequent. This gives the same
+frequent edge labels as only counting those with frequent vertex labels would, since any graph
+containing an edge also contains both of its vertex labels.
+*/
+class label_counter
+{
+  public:
+	void add(const parsed_input_graph_t& graph)
 	{
 		// Temporary sets are necessary to ensure each label is counted at most
 		// once per graph.
-		std::unordered_set<combined_edge_label, combined_edge_label_hash> edge_labels;
-		for (const auto& edge : graph.edges)
+		graph_vertex_labels.clear();
+		for (const auto& vertex : graph.vertices)
 		{
-			const auto from_label = graph.vertices[edge.from].label;
-			const auto to_label = graph.vertices[edge.to].label;
-			if (!freq_vertex_labels.contains(from_label) || !freq_vertex_labels.contains(to_label))
+			if (graph_vertex_labels.insert(vertex.label).second)
 			{
-				continue;
+				// Only count the first occurence.
+				++counts.vertex_labels[vertex.label];
 			}
+		}
 
-			const combined_edge_label combo{from_label, edge.label, to_label};
+		max_graph_size_ =
+			std::max({max_graph_size_, graph.vertices.size(), graph.edges.size()});
 
-			if (edge_labels.insert(combo).second)
+		graph_edge_labels.clear();
+		for (const auto& edge : graph.edges)
+		{
+			const combined_edge_label combo{graph.vertices[edge.from].label, edge.label,
+			                                graph.vertices[edge.to].label};
+			if (graph_edge_labels.insert(combo).second)
 			{
 				// Only count the first occurence.
-				++freq_edge_labels[combo];
+				++counts.edge_labels[combo];
 			}
 		}
 	}
 
-	// Prune infrequent labels.
-	std::erase_if(freq_edge_labels, prune_infrequent{min_freq});
+	//! The largest number of vertices or edges in any graph added so far.
+	[[nodiscard]] std::size_t max_graph_size() const { return max_graph_size_; }
+
+	//! Prunes the infrequent labels, and those forbidden by the constraints, and returns the
+	//! rest.
+	[[nodiscard]] frequent_labels frequent(const std::size_t min_freq,
+	                                       const constraints_t& constraints) &&
+	{
+		std::erase_if(counts.vertex_labels, prune_infrequent{min_freq});
+		std::erase_if(counts.edge_labels, prune_infrequent{min_freq});
+		std::erase_if(counts.vertex_labels, [&constraints](const auto& kv_pair)
+		              { return !constraints.allows_vertex_label(kv_pair.first); });
+		std::erase_if(counts.edge_labels,
+		              [&constraints](const auto& kv_pair)
+		              {
+						  const auto& combo = kv_pair.first;
+						  return !constraints.allows_edge_label(combo.edge_label) ||
+				                 !constraints.allows_vertex_label(combo.from_label) ||
+				                 !constraints.allows_vertex_label(combo.to_label);
+					  });
+		return std::move(counts);
+	}
 
-	return freq_edge_labels;
+  private:
+	frequent_labels counts;
+	std::size_t max_graph_size_{0};
+
+	// Scratch memory for a single graph
+	std::set<vertex_label_t> graph_vertex_labels;
+	std::unordered_set<combined_edge_label, combined_edge_label_hash> graph_edge_labels;
+};
+
+/*!
+Whether the vertex and edge IDs of a graph with graph_size vertices or edges (whichever is more)
+fit in local_id_t, with its largest value left free as a sentinel.
+*/
+template <class local_id_t>
+[[nodiscard]] bool ids_fit(const std::size_t graph_size)
+{
+	return graph_size < std::numeric_limits<local_id_t>::max();
 }
 
 } // namespace
 
-compact_graph_t::compact_graph_t(const parsed_input_graph_t& input,
-                                 const std::span<const edge_t> input_edges,
-                                 std::vector<vertex_id_t>& vertex_id_to_n_edges,
-                                 std::vector<vertex_id_t>& vertex_id_map)
-	: id{input.id}, n_edges{static_cast<std::uint32_t>(input_edges.size())},
-	  edges{std::make_unique<edge_t[]>(2 * input_edges.size())}
+template <class local_id_t>
+void basic_graph_database<local_id_t>::block::add_graph(
+	const parsed_input_graph_t& input, const std::span<const edge_type> input_edges,
+	scratch& scratch_memory)
 {
+	auto& [vertex_id_to_n_edges, vertex_id_map, adjacency_scratch] = scratch_memory;
+
 	vertex_id_to_n_edges.resize(input.vertices.size());
-	std::ranges::fill(vertex_id_to_n_edges, vertex_id_t(0));
+	std::ranges::fill(vertex_id_to_n_edges, local_id_t(0));
 
-	// 1: Determine # of edges per vertex
+	// 1: Determine # of edges per vertex, and the range of edge IDs
+	std::uint32_t graph_n_edges = 0;
 	for (const auto& edge : input_edges)
 	{
 		++vertex_id_to_n_edges[edge.from];
 		++vertex_id_to_n_edges[edge.to];
+		graph_n_edges = std::max(graph_n_edges, static_cast<std::uint32_t>(edge.id + 1));
 	}
 
 	// 2: Remap vertex indexes
 	vertex_id_map.resize(input.vertices.size());
-	vertex_id_t n_vertices{0};
-	for (vertex_id_t vertex_id{0}; vertex_id < input.vertices.size(); ++vertex_id)
+	local_id_t n_kept_vertices{0};
+	for (local_id_t vertex_id{0}; vertex_id < input.vertices.size(); ++vertex_id)
 	{
 		if (vertex_id_to_n_edges[vertex_id] > 0)
 		{
-			assert(n_vertices != std::numeric_limits<vertex_id_t>::max());
-			vertex_id_map[vertex_id] = n_vertices++;
+			assert(n_kept_vertices != std::numeric_limits<local_id_t>::max());
+			vertex_id_map[vertex_id] = n_kept_vertices++;
 		}
 		else
 		{
-			vertex_id_map[vertex_id] = std::numeric_limits<vertex_id_t>::max();
+			vertex_id_map[vertex_id] = std::numeric_limits<local_id_t>::max();
 		}
 	}
 
-	// 3: Prep vertices
-	vertices.reserve(n_vertices);
-	auto iter = edges.get();
-	for (vertex_id_t vertex_id{0}; vertex_id < input.vertices.size(); ++vertex_id)
+	// 3: Prep vertices, and lay out the adjacency lists
+	const auto vertex_start = vertex_labels.size();
+	const auto offsets_start = offsets.size();
+	offsets.push_back(0);
+	for (local_id_t vertex_id{0}; vertex_id < input.vertices.size(); ++vertex_id)
 	{
 		if (vertex_id_to_n_edges[vertex_id] == 0)
 		{
@@ -182,83 +218,500 @@ compact_graph_t::compact_graph_t(const parsed_input_graph_t& input,
 		}
 		const auto& src_vert = input.vertices[vertex_id];
 		assert(src_vert.id == vertex_id);
-		const std::span edge_list{iter, vertex_id_to_n_edges[vertex_id]};
-		assert(edge_list.size() != std::numeric_limits<vertex_id_t>::max());
-
-		vertices.push_back(
-			compact_vertex_t{.label = src_vert.label, .id = vertex_id, .edges = edge_list});
+		assert(vertex_id_to_n_edges[vertex_id] != std::numeric_limits<local_id_t>::max());
 
-		iter += vertex_id_to_n_edges[vertex_id];
+		vertex_labels.push_back(src_vert.label);
+		offsets.push_back(offsets.back() + vertex_id_to_n_edges[vertex_id]);
 	}
+	const auto graph_labels = std::span{vertex_labels}.subspan(vertex_start);
+	const auto graph_offsets = std::span{offsets}.subspan(offsets_start);
 
 	// 4: Copy edges over
+	adjacency_scratch.resize(graph_offsets.back());
 	for (const auto& edge : input_edges)
 	{
 		const auto from = vertex_id_map[edge.from];
 		const auto to = vertex_id_map[edge.to];
-		assert(from != std::numeric_limits<vertex_id_t>::max());
-		assert(to != std::numeric_limits<vertex_id_t>::max());
-
-		// The spans are fixed size, so do some math with the number of vertices to figure out where
-		// we should put the edges:
-		auto& from_vert = vertices[from];
-		from_vert.edges[from_vert.edges.size() - vertex_id_to_n_edges[from_vert.id]--] =
-			edge_t{.from = from, .to = to, .label = edge.label, .id = edge.id};
-		auto& to_vert = vertices[to];
-		to_vert.edges[to_vert.edges.size() - vertex_id_to_n_edges[to_vert.id]--] =
-			edge_t{.from = to, .to = from, .label = edge.label, .id = edge.id};
+		assert(from != std::numeric_limits<local_id_t>::max());
+		assert(to != std::numeric_limits<local_id_t>::max());
+
+		// The lists are fixed size, so do some math with the number of remaining edges to figure
+		// out where we should put the edges:
+		adjacency_scratch[graph_offsets[from + 1u] - vertex_id_to_n_edges[edge.from]--] =
+			edge_type{.from = from, .to = to, .label = edge.label, .id = edge.id};
+		adjacency_scratch[graph_offsets[to + 1u] - vertex_id_to_n_edges[edge.to]--] =
+			edge_type{.from = to, .to = from, .label = edge.label, .id = edge.id};
+	}
+
+	// 5: Sort each adjacency list by edge label, then neighbour label. The extension scans compare
+	// candidates against these labels, so this lets them skip straight to the first admissible one.
+	// Ties are broken by neighbour and edge ID to keep the order deterministic.
+	const auto sort_key = [graph_labels](const edge_type& edge)
+	{ return std::tuple{edge.label, graph_labels[edge.to], edge.to, edge.id}; };
+	for (local_id_t vertex{0}; vertex < n_kept_vertices; ++vertex)
+	{
+		std::ranges::sort(adjacency_scratch.begin() + graph_offsets[vertex],
+		                  adjacency_scratch.begin() + graph_offsets[vertex + 1u], {}, sort_key);
 	}
+
+	for (const auto& edge : adjacency_scratch)
+	{
+		neighbours.push_back(edge.to);
+		neighbour_labels.push_back(graph_labels[edge.to]);
+		edge_labels.push_back(edge.label);
+		edge_ids.push_back(edge.id);
+	}
+
+	ids.push_back(input.id);
+	n_edges.push_back(graph_n_edges);
+	vertex_starts.push_back(vertex_labels.size());
+	adjacency_starts.push_back(neighbours.size());
 }
 
-// TODO:
-[[nodiscard]] auto preprocess(std::vector<parsed_input_graph_t>&& graphs, std::size_t min_freq)
-	-> std::vector<compact_graph_t>
+template <class local_id_t>
+void basic_graph_database<local_id_t>::block::shrink_to_fit()
+{
+	ids.shrink_to_fit();
+	n_edges.shrink_to_fit();
+	vertex_starts.shrink_to_fit();
+	adjacency_starts.shrink_to_fit();
+	vertex_labels.shrink_to_fit();
+	offsets.shrink_to_fit();
+	neighbours.shrink_to_fit();
+	neighbour_labels.shrink_to_fit();
+	edge_labels.shrink_to_fit();
+	edge_ids.shrink_to_fit();
+}
+
+template <class local_id_t>
+void basic_graph_database<local_id_t>::append(block&& new_block)
+{
+	// Moving the block into the list keeps its arrays where they are, so the views can be made
+	// from the stored block.
+	const auto& stored = blocks.emplace_back(std::move(new_block));
+	for (std::size_t index = 0; index < stored.size(); ++index)
+	{
+		const auto vertex_start = stored.vertex_starts[index];
+		const auto n_vertices = stored.vertex_starts[index + 1] - vertex_start;
+		const auto adjacency_start = stored.adjacency_starts[index];
+		const auto n_adjacency = stored.adjacency_starts[index + 1] - adjacency_start;
+
+		graphs.push_back(graph_type{
+			.id = stored.ids[index],
+			.n_edges = stored.n_edges[index],
+			.vertex_labels = std::span{stored.vertex_labels}.subspan(vertex_start, n_vertices),
+			.offsets = std::span{stored.offsets}.subspan(vertex_start + index, n_vertices + 1),
+			.neighbours = std::span{stored.neighbours}.subspan(adjacency_start, n_adjacency),
+			.neighbour_labels =
+				std::span{stored.neighbour_labels}.subspan(adjacency_start, n_adjacency),
+			.edge_labels = std::span{stored.edge_labels}.subspan(adjacency_start, n_adjacency),
+			.edge_ids = std::span{stored.edge_ids}.subspan(adjacency_start, n_adjacency),
+		});
+	}
+}
+
+namespace
+{
+
+//! Reusable scratch memory for building compact graphs, one per thread.
+template <class local_id_t>
+struct compaction_scratch
+{
+	std::vector<basic_edge_t<local_id_t>> frequent_edges;
+	typename basic_graph_database<local_id_t>::scratch database;
+};
+
+/*!
+Whether the edges kept from a graph have every label the constraints require. If not, no pattern
+that is reported can occur in the graph.
+*/
+template <class local_id_t>
+[[nodiscard]] bool has_required_labels(const parsed_input_graph_t& input,
+                                       const std::span<const basic_edge_t<local_id_t>> edges,
+                                       const constraints_t& constraints)
+{
+	const auto has_vertex_label = [&](const vertex_label_t label)
+	{
+		return std::ranges::any_of(edges,
+		                           [&](const basic_edge_t<local_id_t>& edge)
+		                           {
+									   return input.vertices[edge.from].label == label ||
+				                              input.vertices[edge.to].label == label;
+								   });
+	};
+	const auto has_edge_label = [&](const edge_label_t label)
+	{ return std::ranges::find(edges, label, &basic_edge_t<local_id_t>::label) != edges.end(); };
+
+	return std::ranges::all_of(constraints.required_vertex_labels, has_vertex_label) &&
+	       std::ranges::all_of(constraints.required_edge_labels, has_edge_label);
+}
+
+/*!
+Compacts a graph, adding it to result if it has any frequent edges, and the labels the constraints
+require. Frees the data of the input graph as it goes.
+*/
+template <class local_id_t>
+void compact_graph(parsed_input_graph_t& input, const frequent_labels& frequent,
+                   const constraints_t& constraints, compaction_scratch<local_id_t>& scratch,
+                   typename basic_graph_database<local_id_t>::block& result)
+{
+	if (!ids_fit<local_id_t>(std::max(input.vertices.size(), input.edges.size())))
+	{
+		log_error("graph ", input.id, " has too many vertices or edges for ",
+		          8 * sizeof(local_id_t), "-bit IDs");
+	}
+
+	auto& frequent_edges = scratch.frequent_edges;
+
+	for (local_id_t i = 0; i < input.edges.size(); ++i)
+	{
+		const auto& edge = input.edges[i];
+		const auto from_label = input.vertices[edge.from].label;
+		const auto to_label = input.vertices[edge.to].label;
+		const combined_edge_label combo{from_label, edge.label, to_label};
+
+		if (frequent.edge_labels.contains(combo))
+		{
+			assert(frequent.vertex_labels.contains(from_label));
+			assert(frequent.vertex_labels.contains(to_label));
+			frequent_edges.push_back(basic_edge_t<local_id_t>{
+				.from = static_cast<local_id_t>(edge.from),
+				.to = static_cast<local_id_t>(edge.to),
+				.label = edge.label,
+				.id = i,
+			});
+		}
+	}
+
+	// Save memory as we go, force deallocation here
+	input.edges = {};
+
+	if (!frequent_edges.empty() &&
+	    has_required_labels<local_id_t>(input, frequent_edges, constraints))
+	{
+		result.add_graph(input, frequent_edges, scratch.database);
+	}
+
+	input.vertices = {};
+
+	frequent_edges.clear();
+}
+
+//! Graphs are compacted in chunks of this many, each into its own block of the database.
+constexpr std::size_t chunk_size = 256;
+
+//! Compacts a chunk of graphs into result, freeing each input graph as it goes.
+template <class local_id_t>
+void compact_chunk(const std::span<parsed_input_graph_t> graphs, const frequent_labels& frequent,
+                   const constraints_t& constraints, compaction_scratch<local_id_t>& scratch,
+                   typename basic_graph_database<local_id_t>::block& result)
 {
-	const auto frequent_vertex_labels = find_frequent_vertex_labels(graphs, min_freq);
+	for (auto& input : graphs)
+	{
+		compact_graph(input, frequent, constraints, scratch, result);
+	}
+	result.shrink_to_fit();
+}
 
-	const auto frequent_edge_labels =
-		find_frequent_edge_labels(graphs, frequent_vertex_labels, min_freq);
+/*!
+Compacts every graph, over up to n_threads threads, given the frequent labels.
+*/
+template <class local_id_t>
+auto compact_graphs(std::vector<parsed_input_graph_t>& graphs, const frequent_labels& frequent,
+                    const constraints_t& constraints, const std::size_t n_threads)
+	-> basic_graph_database<local_id_t>
+{
+	using database = basic_graph_database<local_id_t>;
 
-	// Reusable scratch memory
-	std::vector<vertex_id_t> vertex_id_to_n_edges;
-	std::vector<vertex_id_t> vertex_id_map;
-	std::vector<edge_t> frequent_edges;
+	// Graphs are handed out to threads in chunks, and the blocks are joined in order at the end so
+	// that the result is in input order. Chunks are small enough that each input graph is still
+	// freed soon after it is compacted.
+	const auto n_chunks = (graphs.size() + chunk_size - 1) / chunk_size;
+	std::vector<typename database::block> chunk_results(n_chunks);
+	std::atomic<std::size_t> next_chunk{0};
 
-	std::vector<compact_graph_t> result;
+	const auto run_worker = [&]
+	{
+		compaction_scratch<local_id_t> scratch;
+		for (auto chunk = next_chunk++; chunk < n_chunks; chunk = next_chunk++)
+		{
+			const auto first = chunk * chunk_size;
+			compact_chunk(
+				std::span{graphs}.subspan(first, std::min(chunk_size, graphs.size() - first)),
+				frequent, constraints, scratch, chunk_results[chunk]);
+		}
+	};
 
-	for (auto&& input : graphs)
+	std::vector<std::thread> helpers;
+	for (std::size_t i = 1; i < std::min(n_threads, n_chunks); ++i)
+	{
+		helpers.emplace_back(run_worker);
+	}
+	run_worker();
+	for (auto& helper : helpers)
 	{
-		for (edge_id_t i = 0; i < input.edges.size(); ++i)
+		helper.join();
+	}
+
+	database result;
+	for (auto& chunk_result : chunk_results)
+	{
+		if (chunk_result.size() != 0)
 		{
-			const auto& edge = input.edges[i];
-			const auto from_label = input.vertices[edge.from].label;
-			const auto to_label = input.vertices[edge.to].label;
-			const combined_edge_label combo{from_label, edge.label, to_label};
+			result.append(std::move(chunk_result));
+		}
+	}
 
-			if (frequent_edge_labels.contains(combo))
+	return result;
+}
+
+/*!
+Reads the graphs from a stream a second time, compacting them over up to n_threads threads as they
+are read.
+*/
+template <class local_id_t>
+auto compact_stream(std::istream& stream, const frequent_labels& frequent,
+                    const constraints_t& constraints, const std::size_t n_threads)
+	-> basic_graph_database<local_id_t>
+{
+	using database = basic_graph_database<local_id_t>;
+
+	// This thread reads the graphs, handing out each full chunk to the others to compact, or
+	// compacting it itself if there are none. It waits while a chunk is already queued for each of
+	// them, so that only a few chunks of parsed graphs are held at once. Each chunk has its own
+	// block, and the blocks are joined in order at the end so that the result is in input order.
+	// A deque, so that helpers can fill their blocks while more are added.
+	std::deque<typename database::block> blocks;
+	std::deque<std::pair<std::size_t, std::vector<parsed_input_graph_t>>> queued;
+	bool read_all = false;
+	std::mutex mutex;
+	std::condition_variable changed;
+
+	const auto run_helper = [&]
+	{
+		compaction_scratch<local_id_t> scratch;
+		std::unique_lock lock{mutex};
+		while (true)
+		{
+			changed.wait(lock, [&] { return !queued.empty() || read_all; });
+			if (queued.empty())
 			{
-				assert(frequent_vertex_labels.contains(from_label));
-				assert(frequent_vertex_labels.contains(to_label));
-				frequent_edges.push_back(
-					edge_t{.from = edge.from, .to = edge.to, .label = edge.label, .id = i});
+				return;
 			}
+			auto [index, chunk] = std::move(queued.front());
+			queued.pop_front();
+			auto& block = blocks[index];
+			lock.unlock();
+			changed.notify_all();
+
+			compact_chunk(std::span{chunk}, frequent, constraints, scratch, block);
+			lock.lock();
 		}
+	};
 
-		// Save memory as we go, force deallocation here
-		input.edges = {};
+	std::vector<std::thread> helpers;
+	for (std::size_t i = 1; i < n_threads; ++i)
+	{
+		helpers.emplace_back(run_helper);
+	}
 
-		if (!frequent_edges.empty())
+	compaction_scratch<local_id_t> scratch;
+	std::vector<parsed_input_graph_t> chunk;
+	const auto hand_out = [&]
+	{
+		if (helpers.empty())
 		{
-			result.push_back(
-				compact_graph_t{input, frequent_edges, vertex_id_to_n_edges, vertex_id_map});
+			compact_chunk(std::span{chunk}, frequent, constraints, scratch, blocks.emplace_back());
+			chunk.clear();
+			return;
 		}
 
-		input.vertices = {};
+		{
+			std::unique_lock lock{mutex};
+			changed.wait(lock, [&] { return queued.size() < helpers.size(); });
+			blocks.emplace_back();
+			queued.emplace_back(blocks.size() - 1, std::move(chunk));
+		}
+		changed.notify_all();
+		chunk = {};
+	};
+	read_input_graphs(stream,
+	                  [&](parsed_input_graph_t&& graph)
+	                  {
+						  chunk.push_back(std::move(graph));
+						  if (chunk.size() == chunk_size)
+						  {
+							  hand_out();
+						  }
+					  });
+	if (!chunk.empty())
+	{
+		hand_out();
+	}
 
-		frequent_edges.clear();
+	{
+		const std::lock_guard lock{mutex};
+		read_all = true;
+	}
+	changed.notify_all();
+	for (auto& helper : helpers)
+	{
+		helper.join();
+	}
+
+	database result;
+	for (auto& block : blocks)
+	{
+		if (block.size() != 0)
+		{
+			result.append(std::move(block));
+		}
 	}
 
 	return result;
 }
 
+/*!
+Counts the labels of the graphs in a stream, then rewinds it to where it started. The stream must
+be seekable.
+*/
+label_counter count_stream(std::istream& stream)
+{
+	const auto start = stream.tellg();
+
+	label_counter counter;
+	read_input_graphs(stream, [&counter](parsed_input_graph_t&& graph) { counter.add(graph); });
+
+	stream.clear();
+	stream.seekg(start);
+	if (!stream)
+		log_error("could not rewind the input to read it a second time");
+	return counter;
+}
+
+/*!
+Calls read with a stream that can be rewound to the current position of the given one: either that
+stream itself, or, if it cannot be seeked (such as a pipe), a copy of the rest of it in memory.
+*/
+template <class read_t>
+auto with_seekable(std::istream& stream, read_t read)
+{
+	if (stream.tellg() != -1)
+	{
+		return read(stream);
+	}
+
+	stream.clear();
+	std::istringstream buffered{
+		std::string{std::istreambuf_iterator<char>{stream}, std::istreambuf_iterator<char>{}}};
+	return read(buffered);
+}
+
+/*!
+Calls build with a value of the narrowest ID type that fits graphs of up to max_graph_size
+vertices or edges, returning its result as an any_graph_database.
+*/
+template <class build_t>
+auto with_narrowest_ids(const std::size_t max_graph_size, build_t build) -> any_graph_database
+{
+	if (ids_fit<std::uint8_t>(max_graph_size))
+	{
+		return build(std::uint8_t{});
+	}
+	if (ids_fit<std::uint16_t>(max_graph_size))
+	{
+		return build(std::uint16_t{});
+	}
+	if (!ids_fit<std::uint32_t>(max_graph_size))
+	{
+		log_error("a graph with ", max_graph_size, " vertices or edges is too large to mine");
+	}
+	return build(std::uint32_t{});
+}
+
+} // namespace
+
+// TODO:
+template <class local_id_t>
+[[nodiscard]] auto preprocess(std::vector<parsed_input_graph_t>&& graphs, std::size_t min_freq,
+                              std::size_t n_threads, const constraints_t& constraints)
+	-> basic_graph_database<local_id_t>
+{
+	label_counter counter;
+	for (const auto& graph : graphs)
+	{
+		counter.add(graph);
+	}
+	return compact_graphs<local_id_t>(graphs, std::move(counter).frequent(min_freq, constraints),
+	                                  constraints, n_threads);
+}
+
+template <class local_id_t>
+auto preprocess(std::istream& stream, const std::size_t min_freq, const std::size_t n_threads,
+                const constraints_t& constraints) -> basic_graph_database<local_id_t>
+{
+	return with_seekable(stream,
+	                     [&](std::istream& seekable)
+	                     {
+							 auto counter = count_stream(seekable);
+							 return compact_stream<local_id_t>(
+								 seekable, std::move(counter).frequent(min_freq, constraints),
+								 constraints, n_threads);
+						 });
+}
+
+auto preprocess_narrowest(std::vector<parsed_input_graph_t>&& graphs, const std::size_t min_freq,
+                          const std::size_t n_threads, const constraints_t& constraints)
+	-> any_graph_database
+{
+	label_counter counter;
+	for (const auto& graph : graphs)
+	{
+		counter.add(graph);
+	}
+	const auto max_graph_size = counter.max_graph_size();
+	const auto frequent = std::move(counter).frequent(min_freq, constraints);
+	return with_narrowest_ids(max_graph_size,
+	                          [&]<class local_id_t>(local_id_t)
+	                          {
+								  return compact_graphs<local_id_t>(graphs, frequent, constraints,
+		                                                            n_threads);
+							  });
+}
+
+auto preprocess_narrowest(std::istream& stream, const std::size_t min_freq,
+                          const std::size_t n_threads, const constraints_t& constraints)
+	-> any_graph_database
+{
+	return with_seekable(
+		stream,
+		[&](std::istream& seekable)
+		{
+			auto counter = count_stream(seekable);
+			const auto max_graph_size = counter.max_graph_size();
+			const auto frequent = std::move(counter).frequent(min_freq, constraints);
+			return with_narrowest_ids(
+				max_graph_size,
+				[&]<class local_id_t>(local_id_t)
+				{
+					return compact_stream<local_id_t>(seekable, frequent, constraints, n_threads);
+				});
+		});
+}
+
+#define SPANG_INSTANTIATE_PREPROCESS(local_id_t)                                                   \
+	template class basic_graph_database<local_id_t>;                                               \
+	template auto preprocess<local_id_t>(std::vector<parsed_input_graph_t>&&, std::size_t,         \
+	                                     std::size_t, const constraints_t&)                        \
+		-> basic_graph_database<local_id_t>;                                                       \
+	template auto preprocess<local_id_t>(std::istream&, std::size_t, std::size_t,                  \
+	                                     const constraints_t&)                                     \
+		-> basic_graph_database<local_id_t>;
+
+SPANG_INSTANTIATE_PREPROCESS(std::uint8_t)
+SPANG_INSTANTIATE_PREPROCESS(std::uint16_t)
+SPANG_INSTANTIATE_PREPROCESS(std::uint32_t)
+
+#undef SPANG_INSTANTIATE_PREPROCESS
+
 } // namespace spang
@@ -1,38 +1,90 @@
 #include <spang/projection.hpp>
 
+#include <algorithm>
+#include <cassert>
+#include <ranges>
+
 namespace spang
 {
 
-static inline void toggle(bool& b) { b = !b; }
+namespace
+{
+std::size_t n_words(const std::size_t n_bits, const std::size_t bits_per_word)
+{
+	return (n_bits + bits_per_word - 1) / bits_per_word;
+}
+} // namespace
+
+template <class local_id_t>
+basic_projection_view<local_id_t>::basic_projection_view(std::size_t max_edges,
+                                                         std::size_t max_vertices)
+	: edge_bits{std::make_unique<std::uint64_t[]>(n_words(max_edges, bits_per_word))},
+	  vertex_refcounts{std::make_unique<local_id_t[]>(max_vertices)},
+	  dfs_vertices{std::make_unique_for_overwrite<vertex_id_t[]>(max_vertices)},
+	  contained_edges{std::make_unique<const basic_edge_t<local_id_t>*[]>(max_edges)},
+	  edge_capacity{max_edges}, vertex_capacity{max_vertices}
+{
+	std::fill_n(dfs_vertices.get(), vertex_capacity, no_vertex);
+}
 
-projection_view::projection_view(std::size_t max_edges, std::size_t max_vertices)
-	: has_edge_{std::make_unique<bool[]>(max_edges)},
-	  vertex_refcounts{std::make_unique<vertex_id_t[]>(max_vertices)},
-	  contained_edges{std::make_unique<const edge_t*[]>(max_edges)}
+template <class local_id_t>
+void basic_projection_view<local_id_t>::clear()
 {
+	for (const auto* edge : std::span{contained_edges.get(), n_contained_edges})
+	{
+		// Any other bits in the word are also from contained edges, so clear it all.
+		edge_bits[edge->id / bits_per_word] = 0;
+		vertex_refcounts[edge->from] = 0;
+		vertex_refcounts[edge->to] = 0;
+		dfs_vertices[edge->from] = no_vertex;
+		dfs_vertices[edge->to] = no_vertex;
+	}
+	n_contained_edges = 0;
 }
 
-void projection_view::build_view(const dfs_projection_link& start, const compact_graph_t& graph)
+template <class local_id_t>
+void basic_projection_view<local_id_t>::start_graph(const basic_compact_graph_t<local_id_t>& graph)
 {
-	if (contained_graph != &graph)
+	// The arrays only need to be cleared where the previous instance set them, unless they have to
+	// grow, in which case they start out clear.
+	clear();
+	if (graph.n_edges > edge_capacity)
+	{
+		edge_capacity = graph.n_edges;
+		edge_bits = std::make_unique<std::uint64_t[]>(n_words(edge_capacity, bits_per_word));
+	}
+	if (graph.n_vertices() > vertex_capacity)
 	{
-		// New graph, start from scratch
-		std::fill_n(has_edge_.get(), graph.n_edges, false);
-		std::fill_n(vertex_refcounts.get(), graph.vertices.size(), static_cast<vertex_id_t>(0));
-		n_contained_edges = 0;
+		vertex_capacity = graph.n_vertices();
+		vertex_refcounts = std::make_unique<local_id_t[]>(vertex_capacity);
+		dfs_vertices = std::make_unique_for_overwrite<vertex_id_t[]>(vertex_capacity);
+		std::fill_n(dfs_vertices.get(), vertex_capacity, no_vertex);
+	}
+	contained_link = nullptr;
+}
 
+template <class local_id_t>
+void basic_projection_view<local_id_t>::build_view(
+	const basic_dfs_projection_link<local_id_t>& start,
+	const std::span<const dfs_edge_t> dfs_code_list)
+{
+	if (contained_link == nullptr)
+	{
+		// First projection in this graph, start from scratch.
 		auto* current_link = &start;
 		do
 		{
+			const auto& code = dfs_code_list[dfs_code_list.size() - n_contained_edges - 1];
 			contained_edges[n_contained_edges++] = &(current_link->edge);
-			has_edge_[current_link->edge.id] = true;
+			set_edge(current_link->edge.id);
 			++vertex_refcounts[current_link->edge.from];
 			++vertex_refcounts[current_link->edge.to];
+			dfs_vertices[current_link->edge.from] = code.from;
+			dfs_vertices[current_link->edge.to] = code.to;
 			current_link = current_link->prev_link;
 		}
 		while (current_link != nullptr);
-
-		contained_graph = &graph;
+		assert(n_contained_edges == dfs_code_list.size());
 	}
 	else
 	{
@@ -48,17 +100,28 @@ void projection_view::build_view(const dfs_projection_link& start, const compact
 
 		do
 		{
+			const auto& code = dfs_code_list[dfs_code_list.size() - modify_index - 1];
 			contained_edges[modify_index++] = &(new_link->edge);
 
-			// Remove old edge
-			toggle(has_edge_[old_link->edge.id]);
-			--vertex_refcounts[old_link->edge.from];
-			--vertex_refcounts[old_link->edge.to];
+			// Remove old edge. Vertices only used by old edges are unmapped. Any vertex still in
+			// use keeps its mapping, since a vertex in an unchanged edge maps to the same DFS
+			// vertex in both instances, and any other vertex is mapped again below.
+			toggle_edge(old_link->edge.id);
+			if (--vertex_refcounts[old_link->edge.from] == 0)
+			{
+				dfs_vertices[old_link->edge.from] = no_vertex;
+			}
+			if (--vertex_refcounts[old_link->edge.to] == 0)
+			{
+				dfs_vertices[old_link->edge.to] = no_vertex;
+			}
 
 			// Add new edge
-			toggle(has_edge_[new_link->edge.id]);
+			toggle_edge(new_link->edge.id);
 			++vertex_refcounts[new_link->edge.from];
 			++vertex_refcounts[new_link->edge.to];
+			dfs_vertices[new_link->edge.from] = code.from;
+			dfs_vertices[new_link->edge.to] = code.to;
 
 			// As the code lengths are the same, this will also catch the case
 			// where new_dfs and old_dfs end up as nullptr at the same time.
@@ -75,34 +138,29 @@ void projection_view::build_view(const dfs_projection_link& start, const compact
 /*!
 Builds a view of a min_dfs_projection.
 */
+template <class local_id_t>
 template <bool include_has_edge_info, bool include_has_vertex_info>
-void projection_view::build_min_view(const graph_t& min_graph,
-                                     const std::span<const min_dfs_projection_link> projections,
-                                     const std::size_t projection_start_index)
+void basic_projection_view<local_id_t>::build_min_view(
+	const std::span<const min_dfs_projection_link> projections,
+	const std::size_t projection_start_index, const std::span<const dfs_edge_t> dfs_code_list)
+	requires std::same_as<local_id_t, vertex_id_t>
 {
-	// Unconditionally include edge references
-	this->n_contained_edges = 0;
-
-	if constexpr (include_has_edge_info)
-	{
-		std::fill_n(this->has_edge_.get(), min_graph.n_edges, false);
-	}
-	if constexpr (include_has_vertex_info)
-	{
-		std::fill_n(this->vertex_refcounts.get(), min_graph.vertices.size(),
-		            static_cast<vertex_id_t>(0));
-	}
+	// Unconditionally include edge references and the vertex mapping
+	this->clear();
 
 	auto projection_index = projection_start_index;
 	while (projection_index != min_dfs_projection_link::no_link)
 	{
 		const auto& [edge, next_index] = projections[projection_index];
+		const auto& code = dfs_code_list[dfs_code_list.size() - this->n_contained_edges - 1];
 
 		this->contained_edges[this->n_contained_edges++] = &edge;
+		this->dfs_vertices[edge.from] = code.from;
+		this->dfs_vertices[edge.to] = code.to;
 
 		if constexpr (include_has_edge_info)
 		{
-			this->has_edge_[edge.id] = true;
+			this->set_edge(edge.id);
 		}
 		if constexpr (include_has_vertex_info)
 		{
@@ -112,20 +170,40 @@ void projection_view::build_min_view(const graph_t& min_graph,
 
 		projection_index = next_index;
 	}
+	assert(this->n_contained_edges == dfs_code_list.size());
 }
 
-void projection_view::build_min_view_no_has_vertex_info(
-	const graph_t& min_graph, const std::span<const min_dfs_projection_link> projections,
-	const std::size_t projection_start_index)
+template <class local_id_t>
+void basic_projection_view<local_id_t>::build_min_view_no_has_vertex_info(
+	const std::span<const min_dfs_projection_link> projections,
+	const std::size_t projection_start_index, const std::span<const dfs_edge_t> dfs_code_list)
+	requires std::same_as<local_id_t, vertex_id_t>
 {
-	build_min_view<true, false>(min_graph, projections, projection_start_index);
+	build_min_view<true, false>(projections, projection_start_index, dfs_code_list);
 }
 
-void projection_view::build_min_view_no_has_edge_info(
-	const graph_t& min_graph, const std::span<const min_dfs_projection_link> projections,
-	const std::size_t projection_start_index)
+template <class local_id_t>
+void basic_projection_view<local_id_t>::build_min_view_no_has_edge_info(
+	const std::span<const min_dfs_projection_link> projections,
+	const std::size_t projection_start_index, const std::span<const dfs_edge_t> dfs_code_list)
+	requires std::same_as<local_id_t, vertex_id_t>
 {
-	build_min_view<false, true>(min_graph, projections, projection_start_index);
+	build_min_view<false, true>(projections, projection_start_index, dfs_code_list);
+}
+
+template class basic_projection_view<std::uint8_t>;
+template class basic_projection_view<std::uint16_t>;
+template class basic_projection_view<std::uint32_t>;
+
+rightmost_path_lookup::rightmost_path_lookup(const std::span<const dfs_edge_t> dfs_code_list,
+                                             const std::span<const edge_id_t> rightmost_path)
+	: rmp_edges(dfs_code_list[rightmost_path[0]].to + std::size_t{1}, no_edge)
+{
+	// The first edge leads to the rightmost vertex, so skip it, as its from vertex is the parent.
+	for (const auto rmp_index : rightmost_path | std::views::drop(1))
+	{
+		rmp_edges[dfs_code_list[rmp_index].from] = rmp_index;
+	}
 }
 
 } // namespace spang
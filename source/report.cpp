@@ -1,24 +1,192 @@
 #include <spang/report.hpp>
 
-// temp
-#include <iostream>
+#include <algorithm>
+#include <cstdint>
+#include <mutex>
+#include <vector>
 
 namespace spang
 {
 
-void report(const std::span<const dfs_edge_t> codes,
-            const std::span<const dfs_projection_link> projections, const std::size_t codes_support)
+namespace
 {
-	(void)projections;
-	(void)codes_support;
 
-	// Temporary: Need proper file opening and whatnot
-	// Do the codes need any conversion?
+/*!
+Reports a pattern with n_instances instances, where graph_index_of(i) is the index of the graph
+instance i is in. Instances are grouped by graph.
+*/
+template <class local_id_t, class graph_index_of_t>
+void report_instances(const std::span<const basic_compact_graph_t<local_id_t>> graphs,
+                      const std::span<const dfs_edge_t> codes, const std::size_t n_instances,
+                      graph_index_of_t graph_index_of, const std::size_t codes_support,
+                      const report_level level, report_sink& sink)
+{
+	if (level == report_level::none)
+	{
+		return;
+	}
+
+	std::vector<graph_id_t> graph_ids;
+	if (level == report_level::graph_ids)
+	{
+		// Each graph starts a new run.
+		for (std::size_t i = 0; i < n_instances; ++i)
+		{
+			if (i == 0 || graph_index_of(i) != graph_index_of(i - 1))
+			{
+				graph_ids.push_back(graphs[static_cast<std::size_t>(graph_index_of(i))].id);
+			}
+		}
+		// Input graph IDs need not be in order.
+		std::ranges::sort(graph_ids);
+	}
+
+	report(codes, codes_support, graph_ids, level, sink);
+}
+
+} // namespace
+
+std::optional<report_level> parse_report_level(const std::string_view name)
+{
+	if (name == "none")
+		return report_level::none;
+	if (name == "support")
+		return report_level::support;
+	if (name == "graph_ids")
+		return report_level::graph_ids;
+	return std::nullopt;
+}
+
+std::optional<output_format> parse_output_format(const std::string_view name)
+{
+	if (name == "text")
+		return output_format::text;
+	if (name == "binary")
+		return output_format::binary;
+	return std::nullopt;
+}
+
+report_sink::report_sink(std::ostream& out, const output_format format) : out_{out}
+{
+	if (format == output_format::binary)
+	{
+		binary.emplace(out);
+	}
+}
+
+void report_sink::write(const std::span<const dfs_edge_t> codes, const std::size_t support,
+                        const std::span<const graph_id_t> graph_ids)
+{
+	const std::lock_guard lock{mutex};
+	if (binary)
+	{
+		binary->write(next_pattern_id++, codes, support, graph_ids);
+	}
+	else
+	{
+		write_text_pattern(out_, next_pattern_id++, codes, support, graph_ids);
+	}
+}
+
+void report_sink::flush()
+{
+	const std::lock_guard lock{mutex};
+	if (binary)
+	{
+		binary->flush();
+	}
+	out_.flush();
+}
+
+report_sink& default_report_sink()
+{
+	static report_sink sink{std::cout};
+	return sink;
+}
+
+void report(const std::span<const dfs_edge_t> codes, const std::size_t codes_support,
+            const std::span<const graph_id_t> graph_ids, const report_level level,
+            report_sink& sink)
+{
+	if (level == report_level::none)
+	{
+		return;
+	}
+
+	sink.write(codes, codes_support,
+	           level == report_level::graph_ids ? graph_ids : std::span<const graph_id_t>{});
+}
+
+template <class local_id_t>
+void report(const std::span<const basic_compact_graph_t<local_id_t>> graphs,
+            const std::span<const dfs_edge_t> codes,
+            const std::span<const basic_dfs_projection_link<local_id_t>> projections,
+            const std::size_t codes_support, const report_level level, report_sink& sink)
+{
+	report_instances(
+		graphs, codes, projections.size(),
+		[projections](const std::size_t i) { return projections[i].graph_id; }, codes_support,
+		level, sink);
+}
+
+template <class local_id_t>
+void report(const std::span<const basic_compact_graph_t<local_id_t>> graphs,
+            const std::span<const dfs_edge_t> codes,
+            const basic_embedding_list<local_id_t>& embeddings, const std::size_t codes_support,
+            const report_level level, report_sink& sink)
+{
+	report_instances(
+		graphs, codes, embeddings.size(),
+		[&embeddings](const std::size_t i) { return embeddings.graph_id(i); }, codes_support,
+		level, sink);
+}
+
+void write_text_pattern(std::ostream& out, const graph_id_t id,
+                        const std::span<const dfs_edge_t> codes, const std::size_t support,
+                        const std::span<const graph_id_t> graph_ids)
+{
+	out << "t # " << id << " * " << support << '\n';
+	for (std::size_t i = 0; i < codes.size(); ++i)
+	{
+		const auto& code = codes[i];
+		if (i == 0)
+		{
+			out << "v " << code.from << ' ' << code.from_label << '\n';
+		}
+		if (code.is_forwards())
+		{
+			out << "v " << code.to << ' ' << code.to_label << '\n';
+		}
+	}
 	for (const auto& code : codes)
 	{
-		std::cout << '(' << code.from << ", " << code.to << ", " << code.from_label << ", "
-				  << code.edge_label << ", " << code.to_label << ")\n";
+		out << "e " << code.from << ' ' << code.to << ' ' << code.edge_label << '\n';
+	}
+	if (!graph_ids.empty())
+	{
+		out << "x:";
+		for (const auto graph_id : graph_ids)
+		{
+			out << ' ' << graph_id;
+		}
+		out << '\n';
 	}
+	out << '\n';
 }
 
+#define SPANG_INSTANTIATE_REPORT(local_id_t)                                                       \
+	template void report(std::span<const basic_compact_graph_t<local_id_t>>,                       \
+	                     std::span<const dfs_edge_t>,                                              \
+	                     std::span<const basic_dfs_projection_link<local_id_t>>, std::size_t,      \
+	                     report_level, report_sink&);                                              \
+	template void report(std::span<const basic_compact_graph_t<local_id_t>>,                       \
+	                     std::span<const dfs_edge_t>, const basic_embedding_list<local_id_t>&,     \
+	                     std::size_t, report_level, report_sink&);
+
+SPANG_INSTANTIATE_REPORT(std::uint8_t)
+SPANG_INSTANTIATE_REPORT(std::uint16_t)
+SPANG_INSTANTIATE_REPORT(std::uint32_t)
+
+#undef SPANG_INSTANTIATE_REPORT
+
 } // namespace spang
@@ -0,0 +1,125 @@
+#include <spang/scheduler.hpp>
+
+#include <algorithm>
+#include <atomic>
+#include <limits>
+#include <memory>
+#include <thread>
+#include <utility>
+
+namespace spang
+{
+
+task_scheduler::task_scheduler(std::size_t n_threads)
+	: n_threads_{std::max<std::size_t>(n_threads, 1)}
+{
+}
+
+void task_scheduler::submit(std::size_t cost, task work)
+{
+	{
+		const std::lock_guard lock{mutex};
+		queue.push(queued_task{.cost = cost, .sequence = n_submitted++, .work = std::move(work)});
+	}
+	task_available.notify_one();
+}
+
+std::size_t task_scheduler::n_idle_threads()
+{
+	const std::lock_guard lock{mutex};
+	const auto n_claimed = n_busy + queue.size();
+	return n_claimed < n_threads_ ? n_threads_ - n_claimed : 0;
+}
+
+void task_scheduler::run_parts(const std::size_t n_parts,
+                               const std::function<void(std::size_t)>& work)
+{
+	struct shared_parts
+	{
+		const std::function<void(std::size_t)>& work;
+		std::size_t n_parts;
+		std::atomic<std::size_t> next_part{0};
+
+		std::mutex mutex;
+		std::condition_variable all_done;
+		std::size_t n_done{0};
+
+		void run_claimed()
+		{
+			for (auto part = next_part++; part < n_parts; part = next_part++)
+			{
+				work(part);
+
+				const std::lock_guard lock{mutex};
+				if (++n_done == n_parts)
+				{
+					all_done.notify_all();
+				}
+			}
+		}
+	};
+
+	// A queued task may only be picked up once the calling thread has run its part, even after this
+	// returns, so the tasks share ownership of the state. They only touch work if they claim a
+	// part, which happens before the last part finishes.
+	const auto parts = std::make_shared<shared_parts>(work, n_parts);
+	for (std::size_t i = 1; i < n_parts; ++i)
+	{
+		submit(std::numeric_limits<std::size_t>::max(), [parts] { parts->run_claimed(); });
+	}
+	parts->run_claimed();
+
+	std::unique_lock lock{parts->mutex};
+	parts->all_done.wait(lock, [&parts] { return parts->n_done == parts->n_parts; });
+}
+
+void task_scheduler::run()
+{
+	std::vector<std::thread> helpers;
+	helpers.reserve(n_threads_ - 1);
+	for (std::size_t i = 1; i < n_threads_; ++i)
+	{
+		helpers.emplace_back([this] { run_worker(); });
+	}
+
+	run_worker();
+
+	for (auto& helper : helpers)
+	{
+		helper.join();
+	}
+}
+
+void task_scheduler::run_worker()
+{
+	std::unique_lock lock{mutex};
+	while (true)
+	{
+		task_available.wait(lock, [this] { return !queue.empty() || n_busy == 0; });
+
+		if (queue.empty())
+		{
+			// Nobody is running a task that could submit more, so we are done. Wake up everyone
+			// else so they can notice the same.
+			task_available.notify_all();
+			return;
+		}
+
+		// top() is const, but the element is about to be discarded anyway.
+		auto work = std::move(const_cast<queued_task&>(queue.top()).work);
+		queue.pop();
+		++n_busy;
+
+		lock.unlock();
+		work();
+		lock.lock();
+
+		--n_busy;
+		if (n_busy == 0 && queue.empty())
+		{
+			task_available.notify_all();
+		}
+	}
+}
+
+} // namespace spang
@@ -0,0 +1,482 @@
+#include <spang/canonical.hpp>
+#include <spang/is_min.hpp>
+#include <spang/logger.hpp>
+#include <spang/seeded.hpp>
+#include <spang/utility.hpp>
+
+#include <algorithm>
+#include <cassert>
+#include <cstdint>
+#include <unordered_map>
+#include <unordered_set>
+#include <variant>
+
+namespace spang
+{
+
+namespace
+{
+
+//! Hashes a DFS code edge. Unlike dfs_edge_hash, includes the from vertex, as extensions here can
+//! start from any vertex.
+struct any_dfs_edge_hash
+{
+	std::size_t operator()(const dfs_edge_t& code) const
+	{
+		std::size_t seed{0};
+		hash_combine(seed, code.from);
+		hash_combine(seed, code.to);
+		hash_combine(seed, code.from_label);
+		hash_combine(seed, code.edge_label);
+		hash_combine(seed, code.to_label);
+		return seed;
+	}
+};
+
+template <class local_id_t>
+using any_extension_map =
+	std::unordered_map<dfs_edge_t, basic_embedding_list<local_id_t>, any_dfs_edge_hash>;
+
+//! The pattern given by a list of codes, whose vertices are numbered in the order they are reached.
+graph_t pattern_graph(const std::span<const dfs_edge_t> codes)
+{
+	graph_t graph{.id = 0, .n_edges = 0, .vertices = {}};
+	const auto add_vertex = [&graph](const vertex_id_t vertex, const vertex_label_t label)
+	{
+		if (vertex == graph.vertices.size())
+		{
+			graph.vertices.push_back(vertex_t{.label = label, .id = vertex, .edges = {}});
+		}
+	};
+	for (const auto& code : codes)
+	{
+		add_vertex(code.from, code.from_label);
+		add_vertex(code.to, code.to_label);
+		graph.add_edge(code.from, code.edge_label, code.to);
+	}
+	return graph;
+}
+
+//! The degree of each vertex of the pattern given by codes.
+std::vector<std::size_t> pattern_degrees(const std::span<const dfs_edge_t> codes)
+{
+	std::vector<std::size_t> degrees;
+	for (const auto& code : codes)
+	{
+		degrees.resize(std::max<std::size_t>(degrees.size(), std::max(code.from, code.to) + 1u));
+		++degrees[code.from];
+		++degrees[code.to];
+	}
+	return degrees;
+}
+
+/*!
+Calls on_match(index) for each index in the adjacency list of vertex whose edge and neighbour
+labels are those of code.
+*/
+template <class local_id_t, class on_match_t>
+void for_each_match(const basic_compact_graph_t<local_id_t>& graph, const local_id_t vertex,
+                    const dfs_edge_t& code, on_match_t on_match)
+{
+	const auto last = graph.offsets[vertex + 1u];
+	for (auto index =
+	         graph.lower_bound(graph.offsets[vertex], last, code.edge_label, code.to_label);
+	     index < last && graph.edge_labels[index] == code.edge_label &&
+	     graph.neighbour_labels[index] == code.to_label;
+	     ++index)
+	{
+		on_match(index);
+	}
+}
+
+/*!
+Matches the edges of a pattern one at a time, backtracking when an edge cannot be matched, until
+the first embedding is found.
+*/
+template <class local_id_t>
+class embedding_search
+{
+  public:
+	embedding_search(const basic_compact_graph_t<local_id_t>& graph,
+	                 const std::span<const dfs_edge_t> codes)
+		: graph_{graph}, codes_{codes}
+	{
+		vertices.reserve(codes.size() + 1);
+		edges.reserve(codes.size());
+	}
+
+	bool run()
+	{
+		const auto& first_code = codes_.front();
+		for (local_id_t vertex{0}; vertex < graph_.n_vertices(); ++vertex)
+		{
+			if (graph_.vertex_labels[vertex] == first_code.from_label)
+			{
+				vertices.assign(1, vertex);
+				if (match(0))
+				{
+					return true;
+				}
+			}
+		}
+		return false;
+	}
+
+  private:
+	//! Matches codes[i] onwards, given a match for the ones before it.
+	bool match(const std::size_t i)
+	{
+		if (i == codes_.size())
+		{
+			return true;
+		}
+
+		const auto& code = codes_[i];
+		const auto from = vertices[code.from];
+		const auto last = graph_.offsets[from + 1u];
+		for (auto index =
+		         graph_.lower_bound(graph_.offsets[from], last, code.edge_label, code.to_label);
+		     index < last && graph_.edge_labels[index] == code.edge_label &&
+		     graph_.neighbour_labels[index] == code.to_label;
+		     ++index)
+		{
+			const auto neighbour = graph_.neighbours[index];
+			const auto edge_id = graph_.edge_ids[index];
+			if (code.is_forwards())
+			{
+				if (std::ranges::find(vertices, neighbour) != vertices.end())
+				{
+					continue;
+				}
+				vertices.push_back(neighbour);
+			}
+			else if (neighbour != vertices[code.to] ||
+			         std::ranges::find(edges, edge_id) != edges.end())
+			{
+				continue;
+			}
+
+			edges.push_back(edge_id);
+			if (match(i + 1))
+			{
+				return true;
+			}
+			edges.pop_back();
+			if (code.is_forwards())
+			{
+				vertices.pop_back();
+			}
+		}
+		return false;
+	}
+
+	const basic_compact_graph_t<local_id_t>& graph_;
+	std::span<const dfs_edge_t> codes_;
+
+	//! The graph vertex each pattern vertex matched so far maps to, and likewise for edges.
+	std::vector<local_id_t> vertices;
+	std::vector<local_id_t> edges;
+};
+
+/*!
+Extends each embedding of the pattern given by codes by the edge given by code, in every way it
+can be.
+*/
+template <class local_id_t>
+auto extend_by(const std::span<const basic_compact_graph_t<local_id_t>> graphs,
+               const std::span<const dfs_edge_t> codes,
+               const basic_embedding_list<local_id_t>& embeddings, const dfs_edge_t& code)
+	-> basic_embedding_list<local_id_t>
+{
+	basic_embedding_list<local_id_t> result;
+	for (std::size_t row = 0; row < embeddings.size(); ++row)
+	{
+		const auto& graph = graphs[static_cast<std::size_t>(embeddings.graph_id(row))];
+		const basic_embedding_view view{embeddings, row, codes};
+		const auto vertices = embeddings.vertices(row);
+
+		for_each_match(graph, vertices[code.from], code,
+		               [&](const auto index)
+		               {
+						   const auto neighbour = graph.neighbours[index];
+						   const auto edge_id = graph.edge_ids[index];
+						   if (code.is_forwards())
+						   {
+							   if (!view.has_vertex(neighbour))
+							   {
+								   result.push_back(embeddings, row, edge_id, neighbour);
+							   }
+						   }
+						   else if (neighbour == vertices[code.to] && !view.has_edge(edge_id))
+						   {
+							   result.push_back(embeddings, row, edge_id,
+				                                basic_embedding_list<local_id_t>::no_vertex);
+						   }
+					   });
+	}
+	return result;
+}
+
+/*!
+Finds every way of adding an edge to the pattern given by codes, at any of its vertices: forwards
+to a new vertex, or backwards between two vertices it already has.
+*/
+template <class local_id_t>
+auto extend_anywhere(const std::span<const basic_compact_graph_t<local_id_t>> graphs,
+                     const std::span<const dfs_edge_t> codes,
+                     const basic_embedding_list<local_id_t>& embeddings)
+	-> any_extension_map<local_id_t>
+{
+	any_extension_map<local_id_t> map;
+	const auto n_vertices = static_cast<vertex_id_t>(embeddings.n_vertices());
+	for (std::size_t row = 0; row < embeddings.size(); ++row)
+	{
+		const auto& graph = graphs[static_cast<std::size_t>(embeddings.graph_id(row))];
+		const basic_embedding_view view{embeddings, row, codes};
+		const auto vertices = embeddings.vertices(row);
+
+		for (vertex_id_t from = 0; from < n_vertices; ++from)
+		{
+			const auto graph_vertex = vertices[from];
+			for (const auto index : graph.adjacency(graph_vertex))
+			{
+				const auto edge_id = graph.edge_ids[index];
+				if (view.has_edge(edge_id))
+				{
+					continue;
+				}
+
+				const auto neighbour = graph.neighbours[index];
+				const auto to = view.dfs_vertex(neighbour);
+				// Edges between two vertices of the pattern are found from both ends, only keep
+				// the one from the later vertex.
+				if (to != view.no_vertex && to > from)
+				{
+					continue;
+				}
+
+				const dfs_edge_t code{
+					.from = from,
+					.to = to == view.no_vertex ? n_vertices : to,
+					.from_label = graph.vertex_labels[graph_vertex],
+					.edge_label = graph.edge_labels[index],
+					.to_label = graph.neighbour_labels[index],
+				};
+				const auto new_vertex =
+					code.is_forwards() ? neighbour : basic_embedding_list<local_id_t>::no_vertex;
+				map[code].push_back(embeddings, row, edge_id, new_vertex);
+			}
+		}
+	}
+	return map;
+}
+
+template <class local_id_t>
+struct seeded_context
+{
+	std::span<const basic_compact_graph_t<local_id_t>> graphs;
+	std::size_t min_freq;
+	report_level level;
+	report_sink& sink;
+	const constraints_t& constraints;
+	//! The minimal DFS codes of every pattern reached so far.
+	std::unordered_set<std::vector<dfs_edge_t>, dfs_code_hash> seen;
+};
+
+/*!
+codes numbers the pattern's vertices in the order they were added, which its embeddings follow, and
+is inout so we can add to the end of it. min_codes is the pattern's minimal DFS code.
+*/
+template <class local_id_t>
+void mine_seeded_recurse(seeded_context<local_id_t>& context, std::vector<dfs_edge_t>& codes,
+                         const basic_embedding_list<local_id_t>& embeddings,
+                         const std::span<const dfs_edge_t> min_codes, const std::size_t support)
+{
+	const auto& constraints = context.constraints;
+	if (constraints.satisfied_by(min_codes))
+	{
+		report(context.graphs, min_codes, embeddings, support, context.level, context.sink);
+	}
+	if (codes.size() >= constraints.max_edges)
+	{
+		return;
+	}
+
+	const auto degrees = pattern_degrees(codes);
+	auto children = extend_anywhere(context.graphs, codes, embeddings);
+	for (auto& [code, child_embeddings] : children)
+	{
+		if (!constraints.allows_extension(degrees, codes.size(), code))
+		{
+			continue;
+		}
+		const auto child_support = child_embeddings.support();
+		if (child_support < context.min_freq)
+		{
+			continue;
+		}
+
+		codes.push_back(code);
+		auto child_min_codes = min_dfs_code(pattern_graph(codes));
+		if (context.seen.insert(child_min_codes).second)
+		{
+			mine_seeded_recurse(context, codes, child_embeddings, child_min_codes, child_support);
+		}
+		codes.pop_back();
+
+		// Nothing else needs these, so free them before moving on to the next child.
+		child_embeddings = {};
+	}
+}
+
+} // namespace
+
+template <class local_id_t>
+auto find_embeddings(const std::span<const basic_compact_graph_t<local_id_t>> graphs,
+                     const std::span<const dfs_edge_t> codes, const label_index* index)
+	-> basic_embedding_list<local_id_t>
+{
+	assert(!codes.empty());
+	const auto& first_code = codes.front();
+
+	basic_embedding_list<local_id_t> embeddings;
+	const auto match_first = [&](const std::size_t graph_index)
+	{
+		const auto& graph = graphs[graph_index];
+		for (local_id_t vertex{0}; vertex < graph.n_vertices(); ++vertex)
+		{
+			if (graph.vertex_labels[vertex] != first_code.from_label)
+			{
+				continue;
+			}
+			for_each_match(graph, vertex, first_code,
+			               [&](const auto adjacency_index)
+			               {
+							   embeddings.push_back(static_cast<graph_id_t>(graph_index), vertex,
+				                                    graph.neighbours[adjacency_index],
+				                                    graph.edge_ids[adjacency_index]);
+						   });
+		}
+	};
+	if (index != nullptr)
+	{
+		for (const auto graph_index : index->candidates(codes))
+		{
+			match_first(graph_index);
+		}
+	}
+	else
+	{
+		for (std::size_t graph_index = 0; graph_index < graphs.size(); ++graph_index)
+		{
+			match_first(graph_index);
+		}
+	}
+
+	for (std::size_t i = 1; i < codes.size() && !embeddings.empty(); ++i)
+	{
+		embeddings = extend_by(graphs, codes.first(i), embeddings, codes[i]);
+	}
+	return embeddings;
+}
+
+template <class local_id_t>
+bool has_embedding(const basic_compact_graph_t<local_id_t>& graph,
+                   const std::span<const dfs_edge_t> codes)
+{
+	assert(!codes.empty());
+	return embedding_search<local_id_t>{graph, codes}.run();
+}
+
+auto seed_code(const parsed_input_graph_t& seed) -> std::vector<dfs_edge_t>
+{
+	graph_t graph{.id = seed.id, .n_edges = 0, .vertices = {}};
+	for (const auto& vertex : seed.vertices)
+	{
+		const auto index = static_cast<vertex_id_t>(graph.vertices.size());
+		graph.vertices.push_back(vertex_t{.label = vertex.label, .id = index, .edges = {}});
+	}
+	for (const auto& edge : seed.edges)
+	{
+		if (static_cast<std::size_t>(edge.from) >= graph.vertices.size() ||
+		    static_cast<std::size_t>(edge.to) >= graph.vertices.size())
+			log_error("seed pattern has an edge to a vertex that does not exist");
+
+		graph.add_edge(static_cast<vertex_id_t>(edge.from), edge.label,
+		               static_cast<vertex_id_t>(edge.to));
+	}
+
+	// A connected graph's code covers every edge, and every vertex, as there are no isolated ones.
+	auto codes = min_dfs_code(graph);
+	const auto n_vertices = std::ranges::count_if(codes, &dfs_edge_t::is_forwards) + 1;
+	if (codes.empty() || codes.size() != seed.edges.size() ||
+	    static_cast<std::size_t>(n_vertices) != seed.vertices.size())
+		log_error("seed pattern must be connected, with at least one edge");
+
+	return codes;
+}
+
+template <class local_id_t>
+void mine_seeded(const std::span<const basic_compact_graph_t<local_id_t>> graphs,
+                 const parsed_input_graph_t& seed, const std::size_t min_freq,
+                 const report_level level, const constraints_t& constraints,
+                 const label_index* index, report_sink& sink)
+{
+	const auto codes = seed_code(seed);
+
+	// Patterns only ever grow, so if the seed breaks an anti-monotone constraint, so does every
+	// pattern containing it.
+	for (std::size_t i = 0; i < codes.size(); ++i)
+	{
+		const auto prefix = std::span{codes}.first(i);
+		if (!constraints.allows_extension(pattern_degrees(prefix), i, codes[i]))
+		{
+			return;
+		}
+	}
+
+	const auto embeddings = find_embeddings(graphs, std::span{codes}, index);
+	const auto support = embeddings.support();
+	if (support == 0 || support < min_freq)
+	{
+		return;
+	}
+
+	seeded_context<local_id_t> context{
+		.graphs = graphs,
+		.min_freq = min_freq,
+		.level = level,
+		.sink = sink,
+		.constraints = constraints,
+		.seen = {codes},
+	};
+	auto growing_codes = codes;
+	mine_seeded_recurse(context, growing_codes, embeddings, codes, support);
+}
+
+void mine_seeded(const any_graph_database& graphs, const parsed_input_graph_t& seed,
+                 const std::size_t min_freq, const report_level level,
+                 const constraints_t& constraints, const label_index* index, report_sink& sink)
+{
+	std::visit([&seed, min_freq, level, &constraints, index, &sink](const auto& database)
+	           { mine_seeded(database, seed, min_freq, level, constraints, index, sink); },
+	           graphs);
+}
+
+#define SPANG_INSTANTIATE_SEEDED(local_id_t)                                                       \
+	template auto find_embeddings(std::span<const basic_compact_graph_t<local_id_t>>,              \
+	                              std::span<const dfs_edge_t>, const label_index*)                 \
+		-> basic_embedding_list<local_id_t>;                                                       \
+	template bool has_embedding(const basic_compact_graph_t<local_id_t>&,                          \
+	                            std::span<const dfs_edge_t>);                                      \
+	template void mine_seeded(std::span<const basic_compact_graph_t<local_id_t>>,                  \
+	                          const parsed_input_graph_t&, std::size_t, report_level,              \
+	                          const constraints_t&, const label_index*, report_sink&);
+
+SPANG_INSTANTIATE_SEEDED(std::uint8_t)
+SPANG_INSTANTIATE_SEEDED(std::uint16_t)
+SPANG_INSTANTIATE_SEEDED(std::uint32_t)
+
+#undef SPANG_INSTANTIATE_SEEDED
+
+} // namespace spang
@@ -0,0 +1,95 @@
+#include <spang/support.hpp>
+
+#include <algorithm>
+#include <cassert>
+#include <cstdint>
+
+namespace spang
+{
+
+std::optional<support_measure> parse_support_measure(const std::string_view name)
+{
+	if (name == "graphs")
+		return support_measure::graphs;
+	if (name == "minimum_image")
+		return support_measure::minimum_image;
+	return std::nullopt;
+}
+
+template <class local_id_t>
+template <class mark_t>
+void basic_mni_counter<local_id_t>::for_each_image(
+	const std::span<const dfs_edge_t> dfs_code_list,
+	const std::span<const basic_dfs_projection_link<local_id_t>> projections, mark_t mark)
+{
+	for (const auto& projection : projections)
+	{
+		auto code_index = dfs_code_list.size();
+		for (const auto* link = &projection; link != nullptr; link = link->prev_link)
+		{
+			assert(code_index != 0);
+			const auto& code = dfs_code_list[--code_index];
+			mark(code.from, link->edge.from);
+			mark(code.to, link->edge.to);
+		}
+	}
+}
+
+template <class local_id_t>
+std::size_t basic_mni_counter<local_id_t>::count(
+	const std::span<const basic_compact_graph_t<local_id_t>> graphs,
+	const std::span<const dfs_edge_t> dfs_code_list,
+	const std::span<const basic_dfs_projection_link<local_id_t>> projections)
+{
+	const auto n_vertices = static_cast<std::size_t>(
+		std::ranges::count_if(dfs_code_list, &dfs_edge_t::is_forwards) + 1);
+	n_images.assign(n_vertices, 0);
+
+	std::size_t first = 0;
+	while (first < projections.size())
+	{
+		// Images are only distinct within a graph, so count each graph's separately.
+		const auto graph_id = projections[first].graph_id;
+		auto last = first + 1;
+		while (last < projections.size() && projections[last].graph_id == graph_id)
+		{
+			++last;
+		}
+		const auto graph_projections = projections.subspan(first, last - first);
+
+		// The bitsets are always clear between graphs, so can be reallocated freely.
+		const auto& graph = graphs[static_cast<std::size_t>(graph_id)];
+		const auto graph_words = (graph.n_vertices() + bits_per_word - 1) / bits_per_word;
+		if (graph_words > words_per_vertex || images.size() < words_per_vertex * n_vertices)
+		{
+			words_per_vertex = std::max(words_per_vertex, graph_words);
+			images.assign(words_per_vertex * n_vertices, 0);
+		}
+
+		for_each_image(dfs_code_list, graph_projections,
+		               [this](const vertex_id_t dfs_vertex, const local_id_t graph_vertex)
+		               {
+						   auto& word = images[dfs_vertex * words_per_vertex +
+			                                   graph_vertex / bits_per_word];
+						   const auto bit = std::uint64_t{1} << (graph_vertex % bits_per_word);
+						   n_images[dfs_vertex] += (word & bit) == 0;
+						   word |= bit;
+					   });
+		for_each_image(dfs_code_list, graph_projections,
+		               [this](const vertex_id_t dfs_vertex, const local_id_t graph_vertex)
+		               {
+						   // Any other bits in the word are also from this graph.
+						   images[dfs_vertex * words_per_vertex + graph_vertex / bits_per_word] = 0;
+					   });
+
+		first = last;
+	}
+
+	return *std::ranges::min_element(n_images);
+}
+
+template class basic_mni_counter<std::uint8_t>;
+template class basic_mni_counter<std::uint16_t>;
+template class basic_mni_counter<std::uint32_t>;
+
+} // namespace spang
@@ -0,0 +1,110 @@
+#include <spang/binary_output.hpp>
+#include <spang/mine.hpp>
+#include <spang/parser.hpp>
+#include <spang/preprocess.hpp>
+#include <spang/report.hpp>
+
+#include <catch2/catch_test_macros.hpp>
+
+#include <fstream>
+#include <limits>
+#include <sstream>
+#include <vector>
+
+using spang::binary_pattern_t;
+using spang::dfs_edge_t;
+
+TEST_CASE("binary output")
+{
+	std::vector<binary_pattern_t> patterns{
+		{.id = 0, .codes = {{0, 1, 0, 3, 1}}, .support = 3, .graph_ids = {2, 40, 1000}},
+		// Negative labels, and a backwards edge.
+		{.id = 1,
+	     .codes = {{0, 1, -5, 0, 0}, {1, 2, 0, 0, 0}, {2, 0, 0, 7, -5}},
+	     .support = 12,
+	     .graph_ids = {}},
+		// Dense enough to be stored as a bitset.
+		{.id = 7, .codes = {{0, 1, 2, 2, 2}}, .support = 0, .graph_ids = {}},
+		{.id = 3, .codes = {{0, 1, 9, 9, 9}, {0, 2, 9, 9, 8}}, .support = 5, .graph_ids = {}},
+		// IDs further apart than the largest graph_id_t.
+		{.id = 4,
+	     .codes = {{0, 1, 0, 0, 0}},
+	     .support = 4,
+	     .graph_ids = {std::numeric_limits<spang::graph_id_t>::min(), -1, 0,
+	                   std::numeric_limits<spang::graph_id_t>::max()}},
+	};
+	for (int i = 100; i < 300; i += 3)
+	{
+		patterns[2].graph_ids.push_back(i);
+	}
+	patterns[2].support = patterns[2].graph_ids.size();
+
+	for (const std::size_t block_size : {1, 2, 100})
+	{
+		std::stringstream stream;
+		{
+			spang::binary_pattern_writer writer{stream, block_size};
+			for (const auto& pattern : patterns)
+			{
+				writer.write(pattern.id, pattern.codes, pattern.support, pattern.graph_ids);
+			}
+		}
+
+		std::vector<binary_pattern_t> read;
+		spang::read_binary_patterns(stream, [&read](binary_pattern_t&& pattern)
+		                            { read.push_back(std::move(pattern)); });
+		CHECK(read == patterns);
+	}
+
+	SECTION("text")
+	{
+		std::stringstream stream;
+		for (const auto& pattern : patterns)
+		{
+			spang::write_text_pattern(stream, pattern.id, pattern.codes, pattern.support,
+			                          pattern.graph_ids);
+		}
+
+		std::vector<spang::parsed_output_graph_t> graphs;
+		spang::read_output_graphs(stream, [&graphs](spang::parsed_output_graph_t&& graph)
+		                          { graphs.push_back(std::move(graph)); });
+		REQUIRE(graphs.size() == patterns.size());
+		CHECK(graphs[1].id == 1);
+		CHECK(graphs[1].support_count == 12);
+		CHECK(graphs[1].vertices ==
+		      std::vector<spang::parsed_vertex_t>{{0, -5}, {1, 0}, {2, 0}});
+		CHECK(graphs[1].edges ==
+		      std::vector<spang::parsed_edge_t>{{0, 1, 0}, {1, 2, 0}, {2, 0, 7}});
+		CHECK(graphs[2].support == patterns[2].graph_ids);
+	}
+}
+
+TEST_CASE("mining to a binary report sink")
+{
+	std::ifstream infile("test/data/Chemical_340.txt");
+	const auto graphs = spang::preprocess(infile, 100);
+
+	std::stringstream text;
+	{
+		spang::report_sink sink{text};
+		spang::mine(graphs, 100, 1, spang::support_measure::graphs, spang::report_level::graph_ids,
+		            {}, sink);
+	}
+	std::stringstream binary;
+	{
+		spang::report_sink sink{binary, spang::output_format::binary};
+		spang::mine(graphs, 100, 1, spang::support_measure::graphs, spang::report_level::graph_ids,
+		            {}, sink);
+	}
+
+	// The same patterns, in the same order, written in the other format.
+	std::stringstream converted;
+	spang::read_binary_patterns(binary,
+	                            [&converted](binary_pattern_t&& pattern)
+	                            {
+									spang::write_text_pattern(converted, pattern.id, pattern.codes,
+			                                                  pattern.support, pattern.graph_ids);
+								});
+	CHECK(text.str().size() > 1000);
+	CHECK(converted.str() == text.str());
+}
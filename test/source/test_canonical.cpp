@@ -0,0 +1,119 @@
+#include <spang/canonical.hpp>
+#include <spang/is_min.hpp>
+#include <spang/parser.hpp>
+
+#include <catch2/catch_test_macros.hpp>
+
+#include <algorithm>
+#include <vector>
+
+using spang::dfs_edge_t;
+using spang::parsed_output_graph_t;
+
+namespace
+{
+
+/*!
+A graph with the given code, as it might appear in an output file, with vertex IDs and the order of
+vertices and edges scrambled.
+*/
+parsed_output_graph_t scrambled_graph(const std::vector<dfs_edge_t>& codes)
+{
+	parsed_output_graph_t graph{};
+	const auto scramble = [](const spang::vertex_id_t id)
+	{ return static_cast<spang::parsed_vertex_id_t>(100 - 7 * id); };
+
+	for (const auto& code : codes)
+	{
+		if (code.is_forwards())
+		{
+			if (graph.vertices.empty())
+			{
+				graph.vertices.push_back({.id = scramble(code.from), .label = code.from_label});
+			}
+			graph.vertices.push_back({.id = scramble(code.to), .label = code.to_label});
+		}
+		// Edges written in the opposite direction.
+		graph.edges.push_back(
+			{.from = scramble(code.to), .to = scramble(code.from), .label = code.edge_label});
+	}
+	std::ranges::reverse(graph.vertices);
+	std::ranges::rotate(graph.edges, graph.edges.begin() + graph.edges.size() / 2);
+	graph.support_count = 3;
+	graph.support = {3, 1, 2};
+	return graph;
+}
+
+} // namespace
+
+TEST_CASE("minimal DFS codes")
+{
+	const std::vector<std::vector<dfs_edge_t>> min_codes{
+		{{0, 1, 0, 0, 0}},
+		{{0, 1, 0, 0, 0}, {1, 2, 0, 0, 0}, {2, 0, 0, 0, 0}, {2, 3, 0, 0, 0}},
+		// Complete graph with 5 vertices
+		{{0, 1, 0, 0, 0}, {1, 2, 0, 0, 0}, {2, 0, 0, 0, 0}, {2, 3, 0, 0, 0}, {3, 0, 0, 0, 0},
+	     {3, 1, 0, 0, 0}, {3, 4, 0, 0, 0}, {4, 0, 0, 0, 0}, {4, 1, 0, 0, 0}, {4, 2, 0, 0, 0}},
+		{{0, 1, 0, 0, 1}, {0, 2, 0, 3, 0}, {2, 3, 0, 3, 0}, {3, 4, 0, 3, 0}, {0, 5, 0, 3, 0}},
+	};
+
+	for (const auto& codes : min_codes)
+	{
+		const auto result = spang::is_min(codes);
+		REQUIRE(result);
+		CHECK(spang::min_dfs_code(result->second) == codes);
+
+		const auto scrambled = scrambled_graph(codes);
+		CHECK(spang::canonical_code(scrambled) == codes);
+
+		auto reordered = scrambled;
+		std::ranges::sort(reordered.support);
+		CHECK(spang::fingerprint(reordered) == spang::fingerprint(scrambled));
+		reordered.support.pop_back();
+		CHECK(spang::fingerprint(reordered) != spang::fingerprint(scrambled));
+		// Nor the same count.
+		auto other_count = scrambled;
+		other_count.support_count = 2;
+		CHECK(spang::fingerprint(other_count) != spang::fingerprint(scrambled));
+	}
+
+	SECTION("cache")
+	{
+		spang::canonical_cache cache{2};
+		for (const auto& codes : min_codes)
+		{
+			const auto scrambled = scrambled_graph(codes);
+			CHECK(cache.get(scrambled).code == codes);
+			// The support is not part of the form, so does not need a new entry.
+			auto other_support = scrambled;
+			other_support.support = {7};
+			CHECK(cache.get(other_support) == spang::canonical_form(scrambled));
+			CHECK(cache.size() <= 2);
+		}
+	}
+
+	SECTION("graphs without edges")
+	{
+		parsed_output_graph_t graph{};
+		graph.vertices = {{.id = 4, .label = 2}, {.id = 1, .label = 1}};
+		const auto form = spang::canonical_form(graph);
+		CHECK(form.code.empty());
+		CHECK(form.vertex_labels == std::vector{1, 2});
+
+		graph.vertices.pop_back();
+		CHECK(spang::fingerprint(graph) != spang::fingerprint(form, 0, {}));
+	}
+
+	SECTION("non-minimal codes")
+	{
+		const std::vector<dfs_edge_t> codes{
+			{0, 1, 0, 0, 1}, {0, 2, 0, 3, 0}, {0, 3, 0, 3, 0}, {3, 4, 0, 3, 0}};
+		REQUIRE_FALSE(spang::is_min(codes));
+
+		const auto min_codes_of_graph = spang::canonical_code(scrambled_graph(codes));
+		CHECK(min_codes_of_graph.size() == codes.size());
+		CHECK(spang::is_min(min_codes_of_graph));
+		CHECK(spang::fingerprint(scrambled_graph(codes)) !=
+		      spang::fingerprint(scrambled_graph(min_codes[3])));
+	}
+}
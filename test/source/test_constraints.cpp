@@ -0,0 +1,186 @@
+#include <spang/constraints.hpp>
+#include <spang/parser.hpp>
+#include <spang/preprocess.hpp>
+
+#include "test_graphs.hpp"
+
+#include <catch2/catch_test_macros.hpp>
+
+#include <span>
+#include <vector>
+
+using spang::constraints_t;
+using spang::dfs_edge_t;
+using spang::parsed_input_graph_t;
+using spang::test::make_path;
+using spang::test::make_star;
+
+namespace
+{
+
+std::vector<spang::graph_id_t> preprocessed_ids(const constraints_t& constraints)
+{
+	std::vector<parsed_input_graph_t> input;
+	input.push_back(make_star(0, 3, 2));
+	input.push_back(make_path(1, 4));
+	input.push_back(make_star(2, 2, 2));
+	const auto graphs = spang::preprocess(std::move(input), 1, 1, constraints);
+
+	std::vector<spang::graph_id_t> ids;
+	for (const auto& graph : graphs)
+	{
+		ids.push_back(graph.id);
+	}
+	return ids;
+}
+
+} // namespace
+
+TEST_CASE("parse constraints")
+{
+	SECTION("valid")
+	{
+		const auto constraints = spang::parse_constraints(
+			"max_edges=5,max_degree=2,forbid_vertex=3,forbid_vertex=-4,forbid_edge=1,"
+			"require_vertex=7,require_edge=8");
+		REQUIRE(constraints);
+		CHECK(constraints->max_edges == 5);
+		CHECK(constraints->max_degree == 2);
+		CHECK(constraints->forbidden_vertex_labels == std::vector{3, -4});
+		CHECK(constraints->forbidden_edge_labels == std::vector{1});
+		CHECK(constraints->required_vertex_labels == std::vector{7});
+		CHECK(constraints->required_edge_labels == std::vector{8});
+	}
+
+	SECTION("empty")
+	{
+		const auto constraints = spang::parse_constraints("");
+		REQUIRE(constraints);
+		CHECK(constraints->max_edges == constraints_t::no_limit);
+		CHECK(constraints->max_degree == constraints_t::no_limit);
+		CHECK(constraints->forbidden_vertex_labels.empty());
+		CHECK(constraints->required_vertex_labels.empty());
+	}
+
+	SECTION("invalid")
+	{
+		CHECK_FALSE(spang::parse_constraints("max_edges"));
+		CHECK_FALSE(spang::parse_constraints("max_edges=x"));
+		CHECK_FALSE(spang::parse_constraints("max_edges=-1"));
+		CHECK_FALSE(spang::parse_constraints("max_size=1"));
+		CHECK_FALSE(spang::parse_constraints("forbid_vertex=1,"));
+		CHECK_FALSE(spang::parse_constraints("forbid_vertex=1 "));
+	}
+}
+
+TEST_CASE("constraint checks")
+{
+	// A triangle, 0 -> 1 -> 2 -> 0.
+	const std::vector<dfs_edge_t> codes{
+		{.from = 0, .to = 1, .from_label = 0, .edge_label = 0, .to_label = 1},
+		{.from = 1, .to = 2, .from_label = 1, .edge_label = 0, .to_label = 2},
+		{.from = 2, .to = 0, .from_label = 2, .edge_label = 1, .to_label = 0},
+	};
+	const std::vector<std::size_t> degrees{2, 2, 2};
+	const dfs_edge_t forwards{.from = 2, .to = 3, .from_label = 2, .edge_label = 0, .to_label = 3};
+
+	SECTION("no constraints")
+	{
+		const constraints_t constraints;
+		CHECK(constraints.allows_extension(degrees, codes.size(), forwards));
+		CHECK(constraints.satisfied_by(codes));
+	}
+
+	SECTION("size and degree")
+	{
+		constraints_t constraints;
+		constraints.max_edges = 3;
+		CHECK_FALSE(constraints.allows_extension(degrees, codes.size(), forwards));
+		constraints.max_edges = 4;
+		CHECK(constraints.allows_extension(degrees, codes.size(), forwards));
+
+		constraints.max_degree = 2;
+		CHECK_FALSE(constraints.allows_extension(degrees, codes.size(), forwards));
+		constraints.max_degree = 3;
+		CHECK(constraints.allows_extension(degrees, codes.size(), forwards));
+		// The vertices of the first edge have no edges yet.
+		constraints.max_degree = 1;
+		CHECK(constraints.allows_extension({}, 0, codes[0]));
+		constraints.max_degree = 0;
+		CHECK_FALSE(constraints.allows_extension({}, 0, codes[0]));
+	}
+
+	SECTION("forbidden labels")
+	{
+		constraints_t constraints;
+		constraints.forbidden_edge_labels = {0};
+		CHECK_FALSE(constraints.allows_extension(degrees, codes.size(), forwards));
+		constraints.forbidden_edge_labels.clear();
+
+		constraints.forbidden_vertex_labels = {3};
+		CHECK_FALSE(constraints.allows_extension(degrees, codes.size(), forwards));
+		// Only the new vertex's label is checked, the others are already in the pattern.
+		constraints.forbidden_vertex_labels = {2};
+		CHECK(constraints.allows_extension(degrees, codes.size(), forwards));
+
+		// Both labels of the first edge are new.
+		constraints.forbidden_vertex_labels = {0};
+		CHECK_FALSE(constraints.allows_extension({}, 0, codes[0]));
+		constraints.forbidden_vertex_labels = {1};
+		CHECK_FALSE(constraints.allows_extension({}, 0, codes[0]));
+	}
+
+	SECTION("required labels")
+	{
+		constraints_t constraints;
+		constraints.required_vertex_labels = {0, 2};
+		CHECK(constraints.satisfied_by(codes));
+		constraints.required_vertex_labels = {0, 3};
+		CHECK_FALSE(constraints.satisfied_by(codes));
+		constraints.required_vertex_labels.clear();
+
+		constraints.required_edge_labels = {1};
+		CHECK(constraints.satisfied_by(codes));
+		CHECK_FALSE(constraints.satisfied_by(std::span{codes}.first(2)));
+		constraints.required_edge_labels = {2};
+		CHECK_FALSE(constraints.satisfied_by(codes));
+	}
+}
+
+TEST_CASE("preprocess with constraints")
+{
+	using ids_t = std::vector<spang::graph_id_t>;
+	constraints_t constraints;
+
+	CHECK(preprocessed_ids(constraints) == ids_t{0, 1, 2});
+
+	SECTION("forbidden labels")
+	{
+		// Stars only have edges to leaves.
+		constraints.forbidden_vertex_labels = {1};
+		CHECK(preprocessed_ids(constraints) == ids_t{1});
+		constraints.forbidden_vertex_labels.clear();
+
+		constraints.forbidden_edge_labels = {0};
+		CHECK(preprocessed_ids(constraints) == ids_t{0, 2});
+	}
+
+	SECTION("required labels")
+	{
+		constraints.required_vertex_labels = {1};
+		CHECK(preprocessed_ids(constraints) == ids_t{0, 2});
+		constraints.required_vertex_labels.clear();
+
+		constraints.required_edge_labels = {0};
+		CHECK(preprocessed_ids(constraints) == ids_t{1});
+		constraints.required_edge_labels = {0, 2};
+		CHECK(preprocessed_ids(constraints).empty());
+	}
+
+	SECTION("forbidden labels are removed before required ones are looked for")
+	{
+		constraints.forbidden_vertex_labels = {1};
+		constraints.required_edge_labels = {2};
+		CHECK(preprocessed_ids(constraints).empty());
+	}
+}
@@ -2,14 +2,149 @@
 #include <spang/is_min.hpp>
 #include <spang/parser.hpp>
 #include <spang/preprocess.hpp>
+#include <spang/scheduler.hpp>
+#include <spang/support.hpp>
+#include <spang/walk.hpp>
 
 #include <catch2/catch_test_macros.hpp>
 
+#include <algorithm>
+#include <fstream>
+#include <limits>
+#include <map>
+#include <span>
+#include <tuple>
+#include <utility>
+#include <vector>
+
 using spang::extend;
 using spang::input_parser;
 using spang::is_min;
 
+namespace
+{
+
+// For each frequent pattern: its support and number of embeddings.
+using pattern_counts =
+	std::map<std::vector<std::tuple<int, int, int, int, int>>, std::pair<std::size_t, std::size_t>>;
+
+auto as_key(const std::span<const spang::dfs_edge_t> codes)
+{
+	std::vector<std::tuple<int, int, int, int, int>> key;
+	for (const auto& code : codes)
+	{
+		key.emplace_back(code.from, code.to, code.from_label, code.edge_label, code.to_label);
+	}
+	return key;
+}
+
+} // namespace
+
 TEST_CASE("extend")
 {
-	//
+	input_parser parser;
+	{
+		std::ifstream infile("test/data/Chemical_340.txt");
+
+		parser.read(infile);
+	}
+	auto data = parser.get_graphs();
+	constexpr std::size_t min_freq = 50;
+	const auto graphs = spang::preprocess(std::move(data), min_freq);
+
+	SECTION("embedding lists find the same patterns and embeddings as projection links")
+	{
+		const std::span<const spang::compact_graph_t> graphs_span{graphs};
+		const spang::walk_limits limits{.min_freq = min_freq,
+		                                .max_edges = std::numeric_limits<std::size_t>::max()};
+
+		pattern_counts from_projections;
+		for (const auto& [code, projections] : extend(graphs))
+		{
+			std::vector codes{code};
+			spang::walk_projections(graphs_span, limits, codes, std::span{projections},
+			                        [&from_projections](const auto& visited, const auto& links)
+			                        {
+										from_projections[as_key(visited)] = {
+											spang::count_graph_support(links), links.size()};
+									});
+		}
+
+		pattern_counts from_embeddings;
+		for (const auto& [code, embeddings] : spang::extend_embeddings(graphs))
+		{
+			std::vector codes{code};
+			spang::walk_embeddings(graphs_span, limits, codes, embeddings,
+			                       [&from_embeddings](const auto& visited, const auto& list)
+			                       {
+									   from_embeddings[as_key(visited)] = {list.support(),
+				                                                           list.size()};
+								   });
+		}
+
+		CHECK(from_projections.size() > 100);
+		CHECK(from_projections == from_embeddings);
+	}
+
+	SECTION("seeding over several threads gives the same projections in the same order")
+	{
+		// Repeat the database, so that it is large enough to be split between threads.
+		std::vector<spang::compact_graph_t> many_graphs;
+		for (int i = 0; i < 16; ++i)
+		{
+			many_graphs.insert(many_graphs.end(), graphs.begin(), graphs.end());
+		}
+
+		const auto serial = extend(many_graphs);
+		spang::extension_map parallel;
+		spang::task_scheduler scheduler{4};
+		scheduler.submit(0, [&] { parallel = extend(many_graphs, &scheduler); });
+		scheduler.run();
+
+		REQUIRE(serial.size() == parallel.size());
+		for (const auto& [code, projections] : serial)
+		{
+			const auto& other = parallel.at(code);
+			REQUIRE(projections.size() == other.size());
+			for (std::size_t i = 0; i < other.size(); ++i)
+			{
+				CHECK(projections[i].graph_id == other[i].graph_id);
+				CHECK(projections[i].edge.id == other[i].edge.id);
+				CHECK(projections[i].prev_link == nullptr);
+				CHECK(other[i].prev_link == nullptr);
+			}
+		}
+	}
+
+	SECTION("extending over several threads gives the same projections in the same order")
+	{
+		const auto seeds = extend(graphs);
+		const auto& [code, projections] = *std::ranges::max_element(
+			seeds, {}, [](const auto& seed) { return seed.second.size(); });
+		// Enough to be split between threads.
+		REQUIRE(projections.size() > 3000);
+
+		const std::vector codes{code};
+		const auto result = is_min(codes);
+		REQUIRE(result);
+		const auto serial = extend(graphs, codes, projections, result->first);
+		spang::extension_map parallel;
+		spang::task_scheduler scheduler{4};
+		scheduler.submit(
+			0, [&] { parallel = extend(graphs, codes, projections, result->first, &scheduler); });
+		scheduler.run();
+
+		REQUIRE(serial.size() == parallel.size());
+		for (const auto& [child_code, child_projections] : serial)
+		{
+			const auto& other = parallel.at(child_code);
+			REQUIRE(child_projections.size() == other.size());
+			for (std::size_t i = 0; i < other.size(); ++i)
+			{
+				CHECK(child_projections[i].graph_id == other[i].graph_id);
+				CHECK(child_projections[i].edge.id == other[i].edge.id);
+				CHECK(child_projections[i].prev_link == other[i].prev_link);
+			}
+		}
+	}
 }
@@ -0,0 +1,48 @@
+#pragma once
+
+#include <spang/graph.hpp>
+#include <spang/parser.hpp>
+
+#include <cstdint>
+#include <vector>
+
+//! Small input graphs for the tests to build databases from.
+namespace spang::test
+{
+
+//! A vertex labelled 0 joined to n_leaves vertices labelled 1, by edges labelled edge_label.
+inline parsed_input_graph_t make_star(const graph_id_t id, const std::uint32_t n_leaves,
+                                      const edge_label_t edge_label = 0)
+{
+	parsed_input_graph_t graph{.id = id, .vertices = {{.id = 0, .label = 0}}, .edges = {}};
+	for (std::uint32_t leaf = 1; leaf <= n_leaves; ++leaf)
+	{
+		graph.vertices.push_back({.id = leaf, .label = 1});
+		graph.edges.push_back({.from = 0, .to = leaf, .label = edge_label});
+	}
+	return graph;
+}
+
+//! A line of vertices with the given labels, joined by edges labelled 0.
+inline parsed_input_graph_t make_path(const graph_id_t id,
+                                      const std::vector<vertex_label_t>& labels)
+{
+	parsed_input_graph_t graph{.id = id, .vertices = {}, .edges = {}};
+	for (std::uint32_t vertex = 0; vertex < labels.size(); ++vertex)
+	{
+		graph.vertices.push_back({.id = vertex, .label = labels[vertex]});
+		if (vertex > 0)
+		{
+			graph.edges.push_back({.from = vertex - 1, .to = vertex, .label = 0});
+		}
+	}
+	return graph;
+}
+
+//! A line of n_vertices vertices labelled 0, joined by edges labelled 0.
+inline parsed_input_graph_t make_path(const graph_id_t id, const std::uint32_t n_vertices)
+{
+	return make_path(id, std::vector<vertex_label_t>(n_vertices, 0));
+}
+
+} // namespace spang::test
@@ -0,0 +1,154 @@
+#include <spang/canonical.hpp>
+#include <spang/incremental.hpp>
+#include <spang/mine.hpp>
+#include <spang/parser.hpp>
+#include <spang/preprocess.hpp>
+#include <spang/seeded.hpp>
+
+#include <catch2/catch_test_macros.hpp>
+
+#include <algorithm>
+#include <cstddef>
+#include <fstream>
+#include <functional>
+#include <span>
+#include <sstream>
+#include <string_view>
+#include <vector>
+
+using spang::dfs_edge_t;
+using spang::input_parser;
+using spang::parsed_input_graph_t;
+
+namespace
+{
+
+//! Runs f, parsing what it reports to the sink it is given as results, each of which must list
+//! its graph IDs.
+spang::previous_results capture_results(const std::function<void(spang::report_sink&)>& f)
+{
+	std::ostringstream out;
+	{
+		spang::report_sink sink{out};
+		f(sink);
+	}
+
+	spang::previous_results results;
+	std::size_t n_patterns = 0;
+	const auto text = out.str();
+	spang::read_output_graphs(std::string_view{text},
+	                          [&](spang::parsed_output_graph_t&& pattern)
+	                          {
+								  CHECK(pattern.support.size() == pattern.support_count);
+								  std::ranges::sort(pattern.support);
+								  results.emplace(spang::canonical_code(pattern),
+		                                          std::move(pattern.support));
+								  ++n_patterns;
+							  });
+	// Each pattern should be reported once.
+	CHECK(results.size() == n_patterns);
+	return results;
+}
+
+} // namespace
+
+TEST_CASE("has embedding")
+{
+	// A triangle with a tail, all labelled 0.
+	std::vector<parsed_input_graph_t> input{{
+		.id = 0,
+		.vertices = {{.id = 0, .label = 0}, {.id = 1, .label = 0}, {.id = 2, .label = 0},
+	                 {.id = 3, .label = 0}},
+		.edges = {{.from = 0, .to = 1, .label = 0}, {.from = 1, .to = 2, .label = 0},
+	              {.from = 2, .to = 0, .label = 0}, {.from = 2, .to = 3, .label = 0}},
+	}};
+	const auto graphs = spang::preprocess(std::move(input), 1);
+	REQUIRE(graphs.size() == 1);
+
+	const dfs_edge_t edge{.from = 0, .to = 1, .from_label = 0, .edge_label = 0, .to_label = 0};
+	const std::vector<dfs_edge_t> triangle{
+		edge,
+		{.from = 1, .to = 2, .from_label = 0, .edge_label = 0, .to_label = 0},
+		{.from = 2, .to = 0, .from_label = 0, .edge_label = 0, .to_label = 0},
+	};
+	CHECK(spang::has_embedding(graphs[0], std::span{triangle}));
+
+	auto with_tail = triangle;
+	with_tail.push_back({.from = 2, .to = 3, .from_label = 0, .edge_label = 0, .to_label = 0});
+	CHECK(spang::has_embedding(graphs[0], std::span{with_tail}));
+
+	// A second tail needs a vertex of degree 3 next to the first, which there is not.
+	with_tail.push_back({.from = 3, .to = 4, .from_label = 0, .edge_label = 0, .to_label = 0});
+	CHECK(!spang::has_embedding(graphs[0], std::span{with_tail}));
+
+	const dfs_edge_t other_label{
+		.from = 0, .to = 1, .from_label = 0, .edge_label = 1, .to_label = 0};
+	CHECK(!spang::has_embedding(graphs[0], std::span{&other_label, 1}));
+}
+
+namespace
+{
+
+/*!
+Checks that mining the first n_old graphs, then updating the results with the rest, finds what
+mining them all at once does.
+*/
+void check_incremental(const std::vector<parsed_input_graph_t>& all_input, const std::size_t n_old,
+                       const std::size_t min_freq)
+{
+	std::vector<parsed_input_graph_t> old_input(
+		all_input.begin(), all_input.begin() + static_cast<std::ptrdiff_t>(n_old));
+	const auto previous = capture_results(
+		[&](spang::report_sink& sink)
+		{
+			spang::mine(spang::preprocess(std::move(old_input), min_freq), min_freq, 1,
+		                spang::support_measure::graphs, spang::report_level::graph_ids, {}, sink);
+		});
+
+	auto data = all_input;
+	const auto graphs = spang::preprocess(std::move(data), min_freq);
+	const auto expected = capture_results(
+		[&](spang::report_sink& sink)
+		{
+			spang::mine(graphs, min_freq, 1, spang::support_measure::graphs,
+		                spang::report_level::graph_ids, {}, sink);
+		});
+
+	// Graphs with no frequent edges are dropped, so count the old ones that are left. The input
+	// graphs are numbered from 0, in order.
+	const auto n_old_graphs = static_cast<std::size_t>(std::ranges::count_if(
+		graphs, [&](const auto& graph) { return static_cast<std::size_t>(graph.id) < n_old; }));
+	const std::span<const spang::compact_graph_t> graphs_span{graphs};
+	const auto incremental = capture_results(
+		[&](spang::report_sink& sink)
+		{
+			spang::mine_incremental(graphs_span.first(n_old_graphs),
+		                            graphs_span.subspan(n_old_graphs), previous, min_freq,
+		                            spang::report_level::graph_ids, sink);
+		});
+
+	CHECK(incremental.size() > previous.size());
+	CHECK(incremental == expected);
+}
+
+} // namespace
+
+TEST_CASE("incremental mining matches mining everything")
+{
+	input_parser parser;
+	{
+		std::ifstream infile("test/data/Chemical_340.txt");
+
+		parser.read(infile);
+	}
+
+	SECTION("a few new graphs")
+	{
+		check_incremental(parser.get_graphs(), 330, 60);
+	}
+
+	SECTION("enough new graphs to make many patterns frequent")
+	{
+		check_incremental(parser.get_graphs(), 250, 60);
+	}
+}
@@ -0,0 +1,48 @@
+#include <spang/label_filter.hpp>
+
+#include <catch2/catch_test_macros.hpp>
+
+#include <cstdint>
+#include <vector>
+
+using spang::simd_level;
+
+TEST_CASE("label filter")
+{
+	// Long enough to cover whole registers of every kernel, plus a partial one. Uses negative
+	// labels too, in case a kernel compares as unsigned.
+	std::vector<spang::vertex_label_t> labels;
+	std::uint32_t state = 12345;
+	for (int i = 0; i < 61; ++i)
+	{
+		state = state * 1103515245u + 12345u;
+		labels.push_back(static_cast<int>((state >> 16) % 9) - 4);
+	}
+
+	const spang::compact_graph_t::adjacency_index_t first = 100;
+
+	for (const auto level : {simd_level::scalar, simd_level::avx2, simd_level::avx512})
+	{
+		for (const int min_label : {-5, -4, 0, 3, 4, 5})
+		{
+			for (std::size_t n = 0; n <= labels.size(); ++n)
+			{
+				std::vector<spang::compact_graph_t::adjacency_index_t> expected;
+				for (std::size_t i = 0; i < n; ++i)
+				{
+					if (labels[i] >= min_label)
+					{
+						expected.push_back(first + static_cast<std::uint32_t>(i));
+					}
+				}
+
+				std::vector<spang::compact_graph_t::adjacency_index_t> out(n);
+				const auto count = spang::filter_labels_at_least(
+					level, std::span{labels}.first(n), min_label, first, out);
+				out.resize(count);
+
+				CHECK(out == expected);
+			}
+		}
+	}
+}
@@ -0,0 +1,107 @@
+#include <spang/label_index.hpp>
+#include <spang/parser.hpp>
+#include <spang/preprocess.hpp>
+#include <spang/seeded.hpp>
+
+#include "test_graphs.hpp"
+
+#include <catch2/catch_test_macros.hpp>
+
+#include <algorithm>
+#include <cstddef>
+#include <fstream>
+#include <span>
+#include <vector>
+
+using spang::dfs_edge_t;
+using spang::input_parser;
+using spang::parsed_input_graph_t;
+using spang::test::make_path;
+
+TEST_CASE("label index")
+{
+	std::vector<parsed_input_graph_t> input;
+	input.push_back(make_path(10, {0, 1, 0}));
+	input.push_back(make_path(20, {1, 2}));
+	input.push_back(make_path(30, {0, 1}));
+	input.push_back(make_path(40, {2, 2, 0}));
+	const auto graphs = spang::preprocess(std::move(input), 1);
+	REQUIRE(graphs.size() == 4);
+	const spang::label_index index{std::span<const spang::compact_graph_t>{graphs}};
+
+	CHECK(index.n_graphs() == 4);
+	CHECK(index.vertex_label_count(0) == 4);
+	CHECK(index.vertex_label_count(2) == 3);
+	CHECK(index.vertex_label_count(7) == 0);
+	CHECK(index.vertex_label_count(0, 0) == 2);
+	CHECK(index.vertex_label_count(0, 2) == 0);
+	CHECK(index.vertex_label_count(3, 2) == 2);
+
+	CHECK(index.graphs_with_vertex_label(0) == std::vector<std::size_t>{0, 2, 3});
+	CHECK(index.graphs_with_vertex_label(7).empty());
+	CHECK(index.graphs_with_edge(0, 0, 1) == std::vector<std::size_t>{0, 2});
+	CHECK(index.graphs_with_edge(1, 0, 0) == std::vector<std::size_t>{0, 2});
+	CHECK(index.graphs_with_edge(2, 0, 2) == std::vector<std::size_t>{3});
+	CHECK(index.graphs_with_edge(0, 1, 1).empty());
+
+	SECTION("candidates")
+	{
+		const dfs_edge_t edge_01{
+			.from = 0, .to = 1, .from_label = 0, .edge_label = 0, .to_label = 1};
+		CHECK(index.candidates(std::span{&edge_01, 1}) == std::vector<std::size_t>{0, 2});
+
+		// Both edges are in graphs 0 and 2, but only graph 0 has two vertices labelled 0.
+		const std::vector<dfs_edge_t> path_010{
+			edge_01, {.from = 1, .to = 2, .from_label = 1, .edge_label = 0, .to_label = 0}};
+		CHECK(index.candidates(std::span{path_010}) == std::vector<std::size_t>{0});
+
+		// No graph has both edges.
+		const std::vector<dfs_edge_t> path_012{
+			edge_01, {.from = 1, .to = 2, .from_label = 1, .edge_label = 0, .to_label = 2}};
+		CHECK(index.candidates(std::span{path_012}).empty());
+
+		const dfs_edge_t unknown{
+			.from = 0, .to = 1, .from_label = 5, .edge_label = 0, .to_label = 1};
+		CHECK(index.candidates(std::span{&unknown, 1}).empty());
+	}
+}
+
+TEST_CASE("label index over many graphs")
+{
+	input_parser parser;
+	{
+		std::ifstream infile("test/data/Chemical_340.txt");
+
+		parser.read(infile);
+	}
+	auto data = parser.get_graphs();
+	const auto graphs = spang::preprocess(std::move(data), 20);
+	const std::span<const spang::compact_graph_t> graphs_span{graphs};
+	const spang::label_index index{graphs_span};
+
+	// Every graph is in the posting list of each of its edges.
+	for (std::size_t graph_index = 0; graph_index < graphs.size(); ++graph_index)
+	{
+		const auto& graph = graphs[graph_index];
+		for (spang::vertex_id_t vertex{0}; vertex < graph.n_vertices(); ++vertex)
+		{
+			for (const auto i : graph.adjacency(vertex))
+			{
+				const auto edge_graphs = index.graphs_with_edge(
+					graph.vertex_labels[vertex], graph.edge_labels[i], graph.neighbour_labels[i]);
+				CHECK(std::ranges::binary_search(edge_graphs, graph_index));
+			}
+		}
+	}
+
+	// A seed's embeddings are the same with or without the index.
+	const std::vector<dfs_edge_t> codes{
+		{.from = 0, .to = 1, .from_label = 8, .edge_label = 0, .to_label = 9},
+		{.from = 1, .to = 2, .from_label = 9, .edge_label = 0, .to_label = 9},
+	};
+	const auto scanned = spang::find_embeddings(graphs_span, std::span{codes});
+	const auto indexed = spang::find_embeddings(graphs_span, std::span{codes}, &index);
+	REQUIRE(scanned.size() > 0);
+	CHECK(indexed.size() == scanned.size());
+	CHECK(indexed.support() == scanned.support());
+}
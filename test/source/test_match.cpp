@@ -0,0 +1,105 @@
+#include <spang/canonical.hpp>
+#include <spang/match.hpp>
+#include <spang/mine.hpp>
+#include <spang/parser.hpp>
+#include <spang/preprocess.hpp>
+
+#include <catch2/catch_test_macros.hpp>
+
+#include <fstream>
+#include <span>
+#include <sstream>
+#include <string_view>
+#include <vector>
+
+using spang::dfs_edge_t;
+using spang::graph_id_t;
+using spang::input_parser;
+using spang::parsed_input_graph_t;
+
+TEST_CASE("match patterns")
+{
+	// A triangle with a tail, a path of four vertices, and a pair of vertices joined twice, all
+	// labelled 0, but for the tail's end.
+	std::vector<parsed_input_graph_t> input;
+	input.push_back({
+		.id = 10,
+		.vertices = {{.id = 0, .label = 0}, {.id = 1, .label = 0}, {.id = 2, .label = 0},
+	                 {.id = 3, .label = 1}},
+		.edges = {{.from = 0, .to = 1, .label = 0}, {.from = 1, .to = 2, .label = 0},
+	              {.from = 2, .to = 0, .label = 0}, {.from = 2, .to = 3, .label = 0}},
+	});
+	input.push_back({
+		.id = 20,
+		.vertices = {{.id = 0, .label = 0}, {.id = 1, .label = 0}, {.id = 2, .label = 0},
+	                 {.id = 3, .label = 0}},
+		.edges = {{.from = 0, .to = 1, .label = 0}, {.from = 1, .to = 2, .label = 0},
+	              {.from = 2, .to = 3, .label = 0}},
+	});
+	input.push_back({
+		.id = 30,
+		.vertices = {{.id = 0, .label = 0}, {.id = 1, .label = 0}},
+		.edges = {{.from = 0, .to = 1, .label = 0}, {.from = 1, .to = 0, .label = 0}},
+	});
+	const auto graphs = spang::preprocess(std::move(input), 1);
+	REQUIRE(graphs.size() == 3);
+
+	const dfs_edge_t edge{.from = 0, .to = 1, .from_label = 0, .edge_label = 0, .to_label = 0};
+	const std::vector<std::vector<dfs_edge_t>> patterns{
+		{edge},
+		// A path of three vertices, which the double edge is not.
+		{edge, {.from = 1, .to = 2, .from_label = 0, .edge_label = 0, .to_label = 0}},
+		// A triangle.
+		{edge,
+	     {.from = 1, .to = 2, .from_label = 0, .edge_label = 0, .to_label = 0},
+	     {.from = 2, .to = 0, .from_label = 0, .edge_label = 0, .to_label = 0}},
+		// A double edge.
+		{edge, {.from = 1, .to = 0, .from_label = 0, .edge_label = 0, .to_label = 0}},
+		// A vertex with three neighbours, one of them labelled 1, in an order whose first vertex
+		// is not the one to start matching from.
+		{{.from = 0, .to = 1, .from_label = 1, .edge_label = 0, .to_label = 0},
+	     {.from = 1, .to = 2, .from_label = 0, .edge_label = 0, .to_label = 0},
+	     {.from = 1, .to = 3, .from_label = 0, .edge_label = 0, .to_label = 0}},
+		// A label that no graph has.
+		{{.from = 0, .to = 1, .from_label = 0, .edge_label = 5, .to_label = 0}},
+	};
+
+	const auto expected = std::vector<std::vector<graph_id_t>>{
+		{10, 20, 30}, {10, 20}, {10}, {30}, {10}, {},
+	};
+	CHECK(spang::match_patterns(std::span<const spang::compact_graph_t>{graphs}, patterns) ==
+	      expected);
+	CHECK(spang::match_patterns(std::span<const spang::compact_graph_t>{graphs}, patterns, 4) ==
+	      expected);
+}
+
+TEST_CASE("match patterns finds what mining does")
+{
+	input_parser parser;
+	{
+		std::ifstream infile("test/data/Chemical_340.txt");
+
+		parser.read(infile);
+	}
+	auto data = parser.get_graphs();
+	const auto graphs = spang::preprocess(std::move(data), 1);
+
+	std::ostringstream out;
+	spang::report_sink sink{out};
+	spang::mine(graphs, 60, 1, spang::support_measure::graphs, spang::report_level::graph_ids, {},
+	            sink);
+
+	std::vector<std::vector<dfs_edge_t>> patterns;
+	std::vector<std::vector<graph_id_t>> mined;
+	const auto text = out.str();
+	spang::read_output_graphs(std::string_view{text},
+	                          [&](spang::parsed_output_graph_t&& pattern)
+	                          {
+								  patterns.push_back(spang::canonical_code(pattern));
+								  mined.push_back(std::move(pattern.support));
+							  });
+	REQUIRE(!patterns.empty());
+
+	CHECK(spang::match_patterns(std::span<const spang::compact_graph_t>{graphs}, patterns, 2) ==
+	      mined);
+}
@@ -4,6 +4,9 @@
 
 #include <array>
 #include <fstream>
+#include <sstream>
+#include <string>
+#include <string_view>
 #include <vector>
 
 TEST_CASE("parse input")
@@ -106,5 +109,50 @@ TEST_CASE("parse input")
 
 TEST_CASE("parse output")
 {
-	// TODO
+	using spang::parsed_edge_t;
+	using spang::parsed_output_graph_t;
+	using spang::parsed_vertex_t;
+
+	// Spacing is as loose as operator>> allows.
+	const std::string_view text = "t # 0 * 2\n"
+	                              "v 0 1\n"
+	                              "v 1 2\n"
+	                              "e 0 1 3\n"
+	                              "x: 4 7\n"
+	                              "\n"
+	                              "t # 1 * 3\r\n"
+	                              "v 0 -1\r\n"
+	                              "v  1\t5\r\n"
+	                              "v 2 5\r\n"
+	                              "e 0 1 0\r\n"
+	                              "e 1 2 -2\r\n"
+	                              "x :1 2 3";
+
+	std::vector<parsed_output_graph_t> graphs;
+	spang::read_output_graphs(text, [&graphs](parsed_output_graph_t&& graph)
+	                          { graphs.push_back(std::move(graph)); });
+
+	REQUIRE(graphs.size() == 2);
+	CHECK(graphs[0].id == 0);
+	CHECK(graphs[0].vertices == std::vector{parsed_vertex_t{0, 1}, parsed_vertex_t{1, 2}});
+	CHECK(graphs[0].edges == std::vector{parsed_edge_t{0, 1, 3}});
+	CHECK(graphs[0].support == std::vector{4, 7});
+	CHECK(graphs[1].id == 1);
+	CHECK(graphs[1].vertices ==
+	      std::vector{parsed_vertex_t{0, -1}, parsed_vertex_t{1, 5}, parsed_vertex_t{2, 5}});
+	CHECK(graphs[1].edges == std::vector{parsed_edge_t{0, 1, 0}, parsed_edge_t{1, 2, -2}});
+	CHECK(graphs[1].support == std::vector{1, 2, 3});
+
+	// Streams are read the same way.
+	std::istringstream stream{std::string{text}};
+	std::size_t i = 0;
+	spang::read_output_graphs(stream,
+	                          [&](parsed_output_graph_t&& graph)
+	                          {
+								  REQUIRE(i < graphs.size());
+								  CHECK(graph == graphs[i]);
+								  CHECK(graph.id == graphs[i].id);
+								  ++i;
+							  });
+	CHECK(i == graphs.size());
 }
@@ -1,11 +1,22 @@
 #include <spang/parser.hpp>
 #include <spang/preprocess.hpp>
 
+#include "test_graphs.hpp"
+
 #include <catch2/catch_test_macros.hpp>
 
 #include <algorithm>
 #include <array>
+#include <cstdint>
 #include <fstream>
+#include <istream>
+#include <iterator>
+#include <sstream>
+#include <streambuf>
+#include <string>
+#include <utility>
+#include <variant>
+#include <vector>
 
 using spang::edge_t;
 using spang::input_parser;
@@ -17,6 +28,24 @@ using spang::preprocess;
 	return edge_t{.from = e.to, .to = e.from, .label = e.label, .id = e.id};
 }
 
+// Check that two databases hold the same graphs, whatever the widths of their IDs
+template <class database_a_t, class database_b_t>
+static void check_same_database(const database_a_t& a, const database_b_t& b)
+{
+	REQUIRE(a.size() == b.size());
+	for (std::size_t i = 0; i < a.size(); ++i)
+	{
+		CHECK(a[i].id == b[i].id);
+		CHECK(a[i].n_edges == b[i].n_edges);
+		CHECK(std::ranges::equal(a[i].vertex_labels, b[i].vertex_labels));
+		CHECK(std::ranges::equal(a[i].offsets, b[i].offsets));
+		CHECK(std::ranges::equal(a[i].neighbours, b[i].neighbours));
+		CHECK(std::ranges::equal(a[i].neighbour_labels, b[i].neighbour_labels));
+		CHECK(std::ranges::equal(a[i].edge_labels, b[i].edge_labels));
+		CHECK(std::ranges::equal(a[i].edge_ids, b[i].edge_ids));
+	}
+}
+
 /*
 Example data (data1) frequencies/occurrences of labels:
 Vertex labels:
@@ -38,6 +67,8 @@ Vertex labels:
 1-8-2: 2
 */
 
+// Adjacency lists are sorted by edge label, then by neighbour label (then by neighbour index).
+
 // TODO: Also add vertex label tests
 // Some results will change:
 // No more empty vertices
@@ -64,12 +95,12 @@ TEST_CASE("preprocess input")
 		constexpr edge_t g1e4{.from = 1, .to = 3, .label = 7, .id = 3};
 		constexpr edge_t g1e5{.from = 2, .to = 3, .label = 6, .id = 4};
 
-		REQUIRE(result[0].vertices.size() == 4);
-		CHECK(std::ranges::equal(result[0].vertices[0].edges, std::array{g1e1, g1e2, g1e3}));
-		CHECK(std::ranges::equal(result[0].vertices[1].edges, std::array{rev(g1e1), g1e4}));
-		CHECK(std::ranges::equal(result[0].vertices[2].edges, std::array{rev(g1e2), g1e5}));
-		CHECK(std::ranges::equal(result[0].vertices[3].edges,
-		                         std::array{rev(g1e3), rev(g1e4), rev(g1e5)}));
+		REQUIRE(result[0].n_vertices() == 4);
+		CHECK(std::ranges::equal(result[0].edges(0), std::array{g1e2, g1e3, g1e1}));
+		CHECK(std::ranges::equal(result[0].edges(1), std::array{g1e4, rev(g1e1)}));
+		CHECK(std::ranges::equal(result[0].edges(2), std::array{g1e5, rev(g1e2)}));
+		CHECK(std::ranges::equal(result[0].edges(3),
+		                         std::array{rev(g1e5), rev(g1e3), rev(g1e4)}));
 
 		constexpr edge_t g2e1{.from = 0, .to = 1, .label = 7, .id = 0};
 		constexpr edge_t g2e2{.from = 0, .to = 2, .label = 6, .id = 1};
@@ -77,12 +108,12 @@ TEST_CASE("preprocess input")
 		constexpr edge_t g2e4{.from = 1, .to = 3, .label = 8, .id = 3};
 		constexpr edge_t g2e5{.from = 2, .to = 3, .label = 5, .id = 4};
 
-		REQUIRE(result[1].vertices.size() == 4);
-		CHECK(std::ranges::equal(result[1].vertices[0].edges, std::array{g2e1, g2e2, g2e3}));
-		CHECK(std::ranges::equal(result[1].vertices[1].edges, std::array{rev(g2e1), g2e4}));
-		CHECK(std::ranges::equal(result[1].vertices[2].edges, std::array{rev(g2e2), g2e5}));
-		CHECK(std::ranges::equal(result[1].vertices[3].edges,
-		                         std::array{rev(g2e3), rev(g2e4), rev(g2e5)}));
+		REQUIRE(result[1].n_vertices() == 4);
+		CHECK(std::ranges::equal(result[1].edges(0), std::array{g2e3, g2e2, g2e1}));
+		CHECK(std::ranges::equal(result[1].edges(1), std::array{rev(g2e1), g2e4}));
+		CHECK(std::ranges::equal(result[1].edges(2), std::array{g2e5, rev(g2e2)}));
+		CHECK(std::ranges::equal(result[1].edges(3),
+		                         std::array{rev(g2e3), rev(g2e5), rev(g2e4)}));
 
 		constexpr edge_t g3e1{.from = 0, .to = 1, .label = 5, .id = 0};
 		constexpr edge_t g3e2{.from = 0, .to = 2, .label = 5, .id = 1};
@@ -90,21 +121,21 @@ TEST_CASE("preprocess input")
 		constexpr edge_t g3e4{.from = 1, .to = 3, .label = 6, .id = 3};
 		constexpr edge_t g3e5{.from = 2, .to = 3, .label = 4, .id = 4};
 
-		REQUIRE(result[2].vertices.size() == 4);
-		CHECK(std::ranges::equal(result[2].vertices[0].edges, std::array{g3e1, g3e2}));
-		CHECK(std::ranges::equal(result[2].vertices[1].edges, std::array{rev(g3e1), g3e3, g3e4}));
-		CHECK(std::ranges::equal(result[2].vertices[2].edges,
-		                         std::array{rev(g3e2), rev(g3e3), g3e5}));
-		CHECK(std::ranges::equal(result[2].vertices[3].edges, std::array{rev(g3e4), rev(g3e5)}));
+		REQUIRE(result[2].n_vertices() == 4);
+		CHECK(std::ranges::equal(result[2].edges(0), std::array{g3e1, g3e2}));
+		CHECK(std::ranges::equal(result[2].edges(1), std::array{rev(g3e1), g3e3, g3e4}));
+		CHECK(std::ranges::equal(result[2].edges(2),
+		                         std::array{g3e5, rev(g3e2), rev(g3e3)}));
+		CHECK(std::ranges::equal(result[2].edges(3), std::array{rev(g3e5), rev(g3e4)}));
 
 		constexpr edge_t g4e1{.from = 0, .to = 1, .label = 4, .id = 0};
 		constexpr edge_t g4e2{.from = 0, .to = 2, .label = 5, .id = 1};
 		constexpr edge_t g4e3{.from = 1, .to = 2, .label = 6, .id = 2};
 
-		REQUIRE(result[3].vertices.size() == 3);
-		CHECK(std::ranges::equal(result[3].vertices[0].edges, std::array{g4e1, g4e2}));
-		CHECK(std::ranges::equal(result[3].vertices[1].edges, std::array{rev(g4e1), g4e3}));
-		CHECK(std::ranges::equal(result[3].vertices[2].edges, std::array{rev(g4e2), rev(g4e3)}));
+		REQUIRE(result[3].n_vertices() == 3);
+		CHECK(std::ranges::equal(result[3].edges(0), std::array{g4e1, g4e2}));
+		CHECK(std::ranges::equal(result[3].edges(1), std::array{rev(g4e1), g4e3}));
+		CHECK(std::ranges::equal(result[3].edges(2), std::array{rev(g4e2), rev(g4e3)}));
 
 		constexpr edge_t g5e1{.from = 0, .to = 1, .label = 5, .id = 0};
 		constexpr edge_t g5e2{.from = 0, .to = 2, .label = 4, .id = 1};
@@ -113,13 +144,13 @@ TEST_CASE("preprocess input")
 		constexpr edge_t g5e5{.from = 2, .to = 3, .label = 6, .id = 4};
 		constexpr edge_t g5e6{.from = 3, .to = 4, .label = 6, .id = 5};
 
-		REQUIRE(result[4].vertices.size() == 5);
-		CHECK(std::ranges::equal(result[4].vertices[0].edges, std::array{g5e1, g5e2, g5e3}));
-		CHECK(std::ranges::equal(result[4].vertices[1].edges, std::array{rev(g5e1), g5e4}));
-		CHECK(std::ranges::equal(result[4].vertices[2].edges, std::array{rev(g5e2), g5e5}));
-		CHECK(std::ranges::equal(result[4].vertices[3].edges,
-		                         std::array{rev(g5e3), rev(g5e4), rev(g5e5), g5e6}));
-		CHECK(std::ranges::equal(result[4].vertices[4].edges, std::array{rev(g5e6)}));
+		REQUIRE(result[4].n_vertices() == 5);
+		CHECK(std::ranges::equal(result[4].edges(0), std::array{g5e2, g5e1, g5e3}));
+		CHECK(std::ranges::equal(result[4].edges(1), std::array{rev(g5e1), g5e4}));
+		CHECK(std::ranges::equal(result[4].edges(2), std::array{rev(g5e2), g5e5}));
+		CHECK(std::ranges::equal(result[4].edges(3),
+		                         std::array{rev(g5e4), rev(g5e3), rev(g5e5), g5e6}));
+		CHECK(std::ranges::equal(result[4].edges(4), std::array{rev(g5e6)}));
 	}
 
 	SECTION("minfreq = 2")
@@ -132,9 +163,9 @@ TEST_CASE("preprocess input")
 		// vertex map: 2 -> 0, 3 -> 1
 		constexpr edge_t g1e5{.from = 0, .to = 1, .label = 6, .id = 4};
 
-		REQUIRE(result[0].vertices.size() == 2);
-		CHECK(std::ranges::equal(result[0].vertices[0].edges, std::array{g1e5}));
-		CHECK(std::ranges::equal(result[0].vertices[1].edges, std::array{rev(g1e5)}));
+		REQUIRE(result[0].n_vertices() == 2);
+		CHECK(std::ranges::equal(result[0].edges(0), std::array{g1e5}));
+		CHECK(std::ranges::equal(result[0].edges(1), std::array{rev(g1e5)}));
 
 		// pruned: v1, g2e1, g2e4
 		// vertex map: 2 -> 1, 3 -> 2
@@ -142,10 +173,10 @@ TEST_CASE("preprocess input")
 		constexpr edge_t g2e3{.from = 0, .to = 2, .label = 4, .id = 2};
 		constexpr edge_t g2e5{.from = 1, .to = 2, .label = 5, .id = 4};
 
-		REQUIRE(result[1].vertices.size() == 3);
-		CHECK(std::ranges::equal(result[1].vertices[0].edges, std::array{g2e2, g2e3}));
-		CHECK(std::ranges::equal(result[1].vertices[1].edges, std::array{rev(g2e2), g2e5}));
-		CHECK(std::ranges::equal(result[1].vertices[2].edges, std::array{rev(g2e3), rev(g2e5)}));
+		REQUIRE(result[1].n_vertices() == 3);
+		CHECK(std::ranges::equal(result[1].edges(0), std::array{g2e3, g2e2}));
+		CHECK(std::ranges::equal(result[1].edges(1), std::array{g2e5, rev(g2e2)}));
+		CHECK(std::ranges::equal(result[1].edges(2), std::array{rev(g2e3), rev(g2e5)}));
 
 		constexpr edge_t g3e1{.from = 0, .to = 1, .label = 5, .id = 0};
 		constexpr edge_t g3e2{.from = 0, .to = 2, .label = 5, .id = 1};
@@ -153,21 +184,21 @@ TEST_CASE("preprocess input")
 		constexpr edge_t g3e4{.from = 1, .to = 3, .label = 6, .id = 3};
 
 		// pruned: g3e5
-		REQUIRE(result[2].vertices.size() == 4);
-		CHECK(std::ranges::equal(result[2].vertices[0].edges, std::array{g3e1, g3e2}));
-		CHECK(std::ranges::equal(result[2].vertices[1].edges, std::array{rev(g3e1), g3e3, g3e4}));
-		CHECK(std::ranges::equal(result[2].vertices[2].edges, std::array{rev(g3e2), rev(g3e3)}));
-		CHECK(std::ranges::equal(result[2].vertices[3].edges, std::array{rev(g3e4)}));
+		REQUIRE(result[2].n_vertices() == 4);
+		CHECK(std::ranges::equal(result[2].edges(0), std::array{g3e1, g3e2}));
+		CHECK(std::ranges::equal(result[2].edges(1), std::array{rev(g3e1), g3e3, g3e4}));
+		CHECK(std::ranges::equal(result[2].edges(2), std::array{rev(g3e2), rev(g3e3)}));
+		CHECK(std::ranges::equal(result[2].edges(3), std::array{rev(g3e4)}));
 
 		// pruned: none
 		constexpr edge_t g4e1{.from = 0, .to = 1, .label = 4, .id = 0};
 		constexpr edge_t g4e2{.from = 0, .to = 2, .label = 5, .id = 1};
 		constexpr edge_t g4e3{.from = 1, .to = 2, .label = 6, .id = 2};
 
-		REQUIRE(result[3].vertices.size() == 3);
-		CHECK(std::ranges::equal(result[3].vertices[0].edges, std::array{g4e1, g4e2}));
-		CHECK(std::ranges::equal(result[3].vertices[1].edges, std::array{rev(g4e1), g4e3}));
-		CHECK(std::ranges::equal(result[3].vertices[2].edges, std::array{rev(g4e2), rev(g4e3)}));
+		REQUIRE(result[3].n_vertices() == 3);
+		CHECK(std::ranges::equal(result[3].edges(0), std::array{g4e1, g4e2}));
+		CHECK(std::ranges::equal(result[3].edges(1), std::array{rev(g4e1), g4e3}));
+		CHECK(std::ranges::equal(result[3].edges(2), std::array{rev(g4e2), rev(g4e3)}));
 
 		// pruned: none
 		constexpr edge_t g5e1{.from = 0, .to = 1, .label = 5, .id = 0};
@@ -177,13 +208,13 @@ TEST_CASE("preprocess input")
 		constexpr edge_t g5e5{.from = 2, .to = 3, .label = 6, .id = 4};
 		constexpr edge_t g5e6{.from = 3, .to = 4, .label = 6, .id = 5};
 
-		REQUIRE(result[4].vertices.size() == 5);
-		CHECK(std::ranges::equal(result[4].vertices[0].edges, std::array{g5e1, g5e2, g5e3}));
-		CHECK(std::ranges::equal(result[4].vertices[1].edges, std::array{rev(g5e1), g5e4}));
-		CHECK(std::ranges::equal(result[4].vertices[2].edges, std::array{rev(g5e2), g5e5}));
-		CHECK(std::ranges::equal(result[4].vertices[3].edges,
-		                         std::array{rev(g5e3), rev(g5e4), rev(g5e5), g5e6}));
-		CHECK(std::ranges::equal(result[4].vertices[4].edges, std::array{rev(g5e6)}));
+		REQUIRE(result[4].n_vertices() == 5);
+		CHECK(std::ranges::equal(result[4].edges(0), std::array{g5e2, g5e1, g5e3}));
+		CHECK(std::ranges::equal(result[4].edges(1), std::array{rev(g5e1), g5e4}));
+		CHECK(std::ranges::equal(result[4].edges(2), std::array{rev(g5e2), g5e5}));
+		CHECK(std::ranges::equal(result[4].edges(3),
+		                         std::array{rev(g5e4), rev(g5e3), rev(g5e5), g5e6}));
+		CHECK(std::ranges::equal(result[4].edges(4), std::array{rev(g5e6)}));
 	}
 
 	constexpr edge_t g3e3{.from = 0, .to = 1, .label = 5, .id = 2};
@@ -203,26 +234,26 @@ TEST_CASE("preprocess input")
 		constexpr edge_t g2e3{.from = 0, .to = 2, .label = 4, .id = 2};
 		constexpr edge_t g2e5{.from = 1, .to = 2, .label = 5, .id = 4};
 
-		REQUIRE(result[0].vertices.size() == 3);
-		CHECK(std::ranges::equal(result[0].vertices[0].edges, std::array{g2e2, g2e3}));
-		CHECK(std::ranges::equal(result[0].vertices[1].edges, std::array{rev(g2e2), g2e5}));
-		CHECK(std::ranges::equal(result[0].vertices[2].edges, std::array{rev(g2e3), rev(g2e5)}));
+		REQUIRE(result[0].n_vertices() == 3);
+		CHECK(std::ranges::equal(result[0].edges(0), std::array{g2e3, g2e2}));
+		CHECK(std::ranges::equal(result[0].edges(1), std::array{g2e5, rev(g2e2)}));
+		CHECK(std::ranges::equal(result[0].edges(2), std::array{rev(g2e3), rev(g2e5)}));
 
 		// pruned: v0, v3, g3e1, g3e2, g3e4, g3e5
 		// vertex map: 1 -> 0, 2 -> 1
-		REQUIRE(result[1].vertices.size() == 2);
-		CHECK(std::ranges::equal(result[1].vertices[0].edges, std::array{g3e3}));
-		CHECK(std::ranges::equal(result[1].vertices[1].edges, std::array{rev(g3e3)}));
+		REQUIRE(result[1].n_vertices() == 2);
+		CHECK(std::ranges::equal(result[1].edges(0), std::array{g3e3}));
+		CHECK(std::ranges::equal(result[1].edges(1), std::array{rev(g3e3)}));
 
 		// pruned: none
 		constexpr edge_t g4e1{.from = 0, .to = 1, .label = 4, .id = 0};
 		constexpr edge_t g4e2{.from = 0, .to = 2, .label = 5, .id = 1};
 		constexpr edge_t g4e3{.from = 1, .to = 2, .label = 6, .id = 2};
 
-		REQUIRE(result[2].vertices.size() == 3);
-		CHECK(std::ranges::equal(result[2].vertices[0].edges, std::array{g4e1, g4e2}));
-		CHECK(std::ranges::equal(result[2].vertices[1].edges, std::array{rev(g4e1), g4e3}));
-		CHECK(std::ranges::equal(result[2].vertices[2].edges, std::array{rev(g4e2), rev(g4e3)}));
+		REQUIRE(result[2].n_vertices() == 3);
+		CHECK(std::ranges::equal(result[2].edges(0), std::array{g4e1, g4e2}));
+		CHECK(std::ranges::equal(result[2].edges(1), std::array{rev(g4e1), g4e3}));
+		CHECK(std::ranges::equal(result[2].edges(2), std::array{rev(g4e2), rev(g4e3)}));
 
 		// pruned: v1, g5e1, g5e4
 		// vertex map: 2 -> 1, 3 -> 2, 4 -> 3
@@ -231,12 +262,12 @@ TEST_CASE("preprocess input")
 		constexpr edge_t g5e5{.from = 1, .to = 2, .label = 6, .id = 4};
 		constexpr edge_t g5e6{.from = 2, .to = 3, .label = 6, .id = 5};
 
-		REQUIRE(result[3].vertices.size() == 4);
-		CHECK(std::ranges::equal(result[3].vertices[0].edges, std::array{g5e2, g5e3}));
-		CHECK(std::ranges::equal(result[3].vertices[1].edges, std::array{rev(g5e2), g5e5}));
-		CHECK(std::ranges::equal(result[3].vertices[2].edges,
+		REQUIRE(result[3].n_vertices() == 4);
+		CHECK(std::ranges::equal(result[3].edges(0), std::array{g5e2, g5e3}));
+		CHECK(std::ranges::equal(result[3].edges(1), std::array{rev(g5e2), g5e5}));
+		CHECK(std::ranges::equal(result[3].edges(2),
 		                         std::array{rev(g5e3), rev(g5e5), g5e6}));
-		CHECK(std::ranges::equal(result[3].vertices[3].edges, std::array{rev(g5e6)}));
+		CHECK(std::ranges::equal(result[3].edges(3), std::array{rev(g5e6)}));
 	}
 
 	SECTION("minfreq = 4")
@@ -250,29 +281,199 @@ TEST_CASE("preprocess input")
 		// pruned: all except g2e5
 		constexpr edge_t g2e5{.from = 0, .to = 1, .label = 5, .id = 4};
 
-		REQUIRE(result[0].vertices.size() == 2);
-		CHECK(std::ranges::equal(result[0].vertices[0].edges, std::array{g2e5}));
-		CHECK(std::ranges::equal(result[0].vertices[1].edges, std::array{rev(g2e5)}));
+		REQUIRE(result[0].n_vertices() == 2);
+		CHECK(std::ranges::equal(result[0].edges(0), std::array{g2e5}));
+		CHECK(std::ranges::equal(result[0].edges(1), std::array{rev(g2e5)}));
 
 		// pruned: all except g3e3
 		constexpr edge_t g3e3_final{.from = 0, .to = 1, .label = 5, .id = 2};
 
-		REQUIRE(result[1].vertices.size() == 2);
-		CHECK(std::ranges::equal(result[1].vertices[0].edges, std::array{g3e3_final}));
-		CHECK(std::ranges::equal(result[1].vertices[1].edges, std::array{rev(g3e3_final)}));
+		REQUIRE(result[1].n_vertices() == 2);
+		CHECK(std::ranges::equal(result[1].edges(0), std::array{g3e3_final}));
+		CHECK(std::ranges::equal(result[1].edges(1), std::array{rev(g3e3_final)}));
 
 		// pruned: g4e1, g4e3
 		constexpr edge_t g4e2{.from = 0, .to = 1, .label = 5, .id = 1};
 
-		REQUIRE(result[2].vertices.size() == 2);
-		CHECK(std::ranges::equal(result[2].vertices[0].edges, std::array{g4e2}));
-		CHECK(std::ranges::equal(result[2].vertices[1].edges, std::array{rev(g4e2)}));
+		REQUIRE(result[2].n_vertices() == 2);
+		CHECK(std::ranges::equal(result[2].edges(0), std::array{g4e2}));
+		CHECK(std::ranges::equal(result[2].edges(1), std::array{rev(g4e2)}));
 
 		// pruned: all but g5e3, also v1
 		constexpr edge_t g5e3{.from = 0, .to = 1, .label = 5, .id = 2};
 
-		REQUIRE(result[3].vertices.size() == 2);
-		CHECK(std::ranges::equal(result[3].vertices[0].edges, std::array{g5e3}));
-		CHECK(std::ranges::equal(result[3].vertices[1].edges, std::array{rev(g5e3)}));
+		REQUIRE(result[3].n_vertices() == 2);
+		CHECK(std::ranges::equal(result[3].edges(0), std::array{g5e3}));
+		CHECK(std::ranges::equal(result[3].edges(1), std::array{rev(g5e3)}));
+	}
+}
+
+TEST_CASE("preprocess sorts adjacency lists")
+{
+	input_parser parser;
+	{
+		std::ifstream infile("test/data/Chemical_340.txt");
+
+		parser.read(infile);
+	}
+	auto data = parser.get_graphs();
+	const auto result = preprocess(std::move(data), 20);
+
+	for (const auto& graph : result)
+	{
+		for (spang::vertex_id_t vertex{0}; vertex < graph.n_vertices(); ++vertex)
+		{
+			const auto key = [&](const auto index)
+			{ return std::pair{graph.edge_labels[index], graph.neighbour_labels[index]}; };
+
+			const auto adjacency = graph.adjacency(vertex);
+			CHECK(std::ranges::is_sorted(adjacency, {}, key));
+
+			// Compare the binary search against a linear one, for every label in the list.
+			for (const auto index : adjacency)
+			{
+				const auto [edge_label, neighbour_label] = key(index);
+				const auto expected =
+					*std::ranges::find_if(adjacency, [&](const auto other)
+				                          { return key(other) >= key(index); });
+				CHECK(graph.lower_bound(graph.offsets[vertex], graph.offsets[vertex + 1u],
+				                        edge_label, neighbour_label) == expected);
+			}
+		}
+	}
+}
+
+TEST_CASE("preprocess over several threads")
+{
+	input_parser parser;
+	{
+		std::ifstream infile("test/data/Chemical_340.txt");
+
+		parser.read(infile);
+	}
+	auto data = parser.get_graphs();
+	auto data_copy = data;
+	const auto serial = preprocess(std::move(data), 20);
+	// Enough threads for several to get work, as graphs are handed out in chunks.
+	const auto parallel = preprocess(std::move(data_copy), 20, 4);
+
+	check_same_database(serial, parallel);
+}
+
+TEST_CASE("preprocess while streaming")
+{
+	input_parser parser;
+	{
+		std::ifstream infile("test/data/Chemical_340.txt");
+
+		parser.read(infile);
+	}
+
+	for (const std::size_t min_freq : {1, 20, 100})
+	{
+		auto data = parser.get_graphs();
+		const auto expected = preprocess(std::move(data), min_freq);
+
+		std::ifstream infile("test/data/Chemical_340.txt");
+		const auto streamed = preprocess(infile, min_freq);
+		check_same_database(expected, streamed);
+
+		// Compacted by other threads as it is read, in more than one chunk.
+		std::ifstream parallel_infile("test/data/Chemical_340.txt");
+		const auto parallel = preprocess(parallel_infile, min_freq, 4);
+		check_same_database(expected, parallel);
+	}
+}
+
+// A stream buffer over text that cannot be seeked, as for a pipe
+class unseekable_buffer : public std::streambuf
+{
+  public:
+	explicit unseekable_buffer(std::string text) : text_{std::move(text)}
+	{
+		setg(text_.data(), text_.data(), text_.data() + text_.size());
+	}
+
+  private:
+	std::string text_;
+};
+
+TEST_CASE("preprocess while streaming from a stream that cannot be rewound")
+{
+	input_parser parser;
+	std::string text;
+	{
+		std::ifstream infile("test/data/Chemical_340.txt");
+		text.assign(std::istreambuf_iterator<char>{infile}, std::istreambuf_iterator<char>{});
+
+		std::istringstream text_in{text};
+		parser.read(text_in);
+	}
+
+	auto data = parser.get_graphs();
+	const auto expected = preprocess(std::move(data), 20);
+
+	unseekable_buffer buffer{text};
+	std::istream unseekable{&buffer};
+	REQUIRE(unseekable.tellg() == -1);
+	const auto streamed = preprocess(unseekable, 20);
+	CHECK(streamed.size() > 0);
+	check_same_database(expected, streamed);
+
+	unseekable_buffer narrowest_buffer{text};
+	std::istream narrowest_unseekable{&narrowest_buffer};
+	const auto narrowest = spang::preprocess_narrowest(narrowest_unseekable, 20, 3);
+	const auto* result = std::get_if<spang::basic_graph_database<std::uint8_t>>(&narrowest);
+	REQUIRE(result != nullptr);
+	check_same_database(expected, *result);
+}
+
+TEST_CASE("preprocess picks the narrowest IDs that fit")
+{
+	SECTION("small graphs")
+	{
+		input_parser parser;
+		{
+			std::ifstream infile("test/data/Chemical_340.txt");
+
+			parser.read(infile);
+		}
+		auto data = parser.get_graphs();
+		auto data_copy = data;
+		const auto expected = preprocess(std::move(data), 20);
+		const auto narrowest = spang::preprocess_narrowest(std::move(data_copy), 20);
+
+		std::ifstream infile("test/data/Chemical_340.txt");
+		const auto streamed = spang::preprocess_narrowest(infile, 20);
+		CHECK(streamed.index() == 0);
+
+		const auto* result = std::get_if<spang::basic_graph_database<std::uint8_t>>(&narrowest);
+		REQUIRE(result != nullptr);
+		check_same_database(expected, *result);
+		check_same_database(expected,
+		                    std::get<spang::basic_graph_database<std::uint8_t>>(streamed));
+	}
+
+	SECTION("large graphs")
+	{
+		// Paths, so that the number of edges is one less than the number of vertices.
+		const auto preprocess_path = [](const std::uint32_t n_vertices)
+		{
+			std::vector<spang::parsed_input_graph_t> graphs;
+			graphs.push_back(spang::test::make_path(0, n_vertices));
+			return spang::preprocess_narrowest(std::move(graphs), 1);
+		};
+
+		CHECK(preprocess_path(254).index() == 0);
+		CHECK(preprocess_path(255).index() == 1);
+		CHECK(preprocess_path(65535).index() == 2);
+
+		const auto result = preprocess_path(70000);
+		const auto& graphs = std::get<spang::basic_graph_database<std::uint32_t>>(result);
+		REQUIRE(graphs.size() == 1);
+		REQUIRE(graphs[0].n_vertices() == 70000);
+		CHECK(std::ranges::equal(graphs[0].edges(69999),
+		                         std::array{spang::basic_edge_t<std::uint32_t>{
+									 .from = 69999, .to = 69998, .label = 0, .id = 69998}}));
 	}
 }
@@ -0,0 +1,145 @@
+#include <spang/mine.hpp>
+#include <spang/parser.hpp>
+#include <spang/preprocess.hpp>
+#include <spang/report.hpp>
+
+#include <catch2/catch_test_macros.hpp>
+
+#include <sstream>
+#include <string>
+#include <vector>
+
+using spang::dfs_edge_t;
+using spang::graph_id_t;
+using spang::parsed_input_graph_t;
+using spang::report_level;
+
+namespace
+{
+
+//! The text a report_sink writes for each of two patterns at level, one after the other.
+std::string report_two(const report_level level)
+{
+	const std::vector<dfs_edge_t> path{
+		{.from = 0, .to = 1, .from_label = 3, .edge_label = 0, .to_label = 4},
+		{.from = 1, .to = 2, .from_label = 4, .edge_label = 1, .to_label = 3}};
+	const std::vector<dfs_edge_t> triangle{
+		{.from = 0, .to = 1, .from_label = 5, .edge_label = 0, .to_label = 5},
+		{.from = 1, .to = 2, .from_label = 5, .edge_label = 0, .to_label = 5},
+		{.from = 2, .to = 0, .from_label = 5, .edge_label = 2, .to_label = 5}};
+	const std::vector<graph_id_t> path_graphs{3, 8};
+	const std::vector<graph_id_t> triangle_graphs{1, 2, 9};
+
+	std::ostringstream out;
+	spang::report_sink sink{out};
+	spang::report(path, 2, path_graphs, level, sink);
+	spang::report(triangle, 3, triangle_graphs, level, sink);
+	return out.str();
+}
+
+} // namespace
+
+TEST_CASE("report levels")
+{
+	SECTION("none")
+	{
+		CHECK(report_two(report_level::none).empty());
+	}
+
+	SECTION("support")
+	{
+		// Patterns are numbered from 0 in the order they are written, with no list of graph IDs.
+		CHECK(report_two(report_level::support) == "t # 0 * 2\n"
+		                                           "v 0 3\n"
+		                                           "v 1 4\n"
+		                                           "v 2 3\n"
+		                                           "e 0 1 0\n"
+		                                           "e 1 2 1\n"
+		                                           "\n"
+		                                           "t # 1 * 3\n"
+		                                           "v 0 5\n"
+		                                           "v 1 5\n"
+		                                           "v 2 5\n"
+		                                           "e 0 1 0\n"
+		                                           "e 1 2 0\n"
+		                                           "e 2 0 2\n"
+		                                           "\n");
+	}
+
+	SECTION("graph_ids")
+	{
+		CHECK(report_two(report_level::graph_ids) == "t # 0 * 2\n"
+		                                             "v 0 3\n"
+		                                             "v 1 4\n"
+		                                             "v 2 3\n"
+		                                             "e 0 1 0\n"
+		                                             "e 1 2 1\n"
+		                                             "x: 3 8\n"
+		                                             "\n"
+		                                             "t # 1 * 3\n"
+		                                             "v 0 5\n"
+		                                             "v 1 5\n"
+		                                             "v 2 5\n"
+		                                             "e 0 1 0\n"
+		                                             "e 1 2 0\n"
+		                                             "e 2 0 2\n"
+		                                             "x: 1 2 9\n"
+		                                             "\n");
+	}
+}
+
+TEST_CASE("report levels when mining")
+{
+	// Only the edge 1-2 is in at least two graphs, and the graphs are not in ID order.
+	std::vector<parsed_input_graph_t> input{
+		{.id = 30, .vertices = {{0, 1}, {1, 2}}, .edges = {{0, 1, 0}}},
+		{.id = 10, .vertices = {{0, 1}, {1, 2}, {2, 1}}, .edges = {{0, 1, 0}, {1, 2, 0}}},
+		{.id = 20, .vertices = {{0, 2}, {1, 1}}, .edges = {{0, 1, 0}}},
+	};
+	const auto graphs = spang::preprocess(std::move(input), 2);
+
+	const auto mine_at = [&graphs](const report_level level)
+	{
+		std::ostringstream out;
+		spang::report_sink sink{out};
+		spang::mine(graphs, 2, 1, spang::support_measure::graphs, level, {}, sink);
+		return out.str();
+	};
+
+	CHECK(mine_at(report_level::none).empty());
+	CHECK(mine_at(report_level::support) == "t # 0 * 3\n"
+	                                        "v 0 1\n"
+	                                        "v 1 2\n"
+	                                        "e 0 1 0\n"
+	                                        "\n");
+	// The graph IDs are sorted, whatever order the graphs were in.
+	CHECK(mine_at(report_level::graph_ids) == "t # 0 * 3\n"
+	                                          "v 0 1\n"
+	                                          "v 1 2\n"
+	                                          "e 0 1 0\n"
+	                                          "x: 10 20 30\n"
+	                                          "\n");
+}
+
+TEST_CASE("parse report level")
+{
+	CHECK(spang::parse_report_level("none") == report_level::none);
+	CHECK(spang::parse_report_level("support") == report_level::support);
+	CHECK(spang::parse_report_level("graph_ids") == report_level::graph_ids);
+
+	for (const auto* const name : {"", "Support", "graph-ids", "ids", "support "})
+	{
+		CHECK_FALSE(spang::parse_report_level(name).has_value());
+	}
+}
+
+TEST_CASE("parse output format")
+{
+	CHECK(spang::parse_output_format("text") == spang::output_format::text);
+	CHECK(spang::parse_output_format("binary") == spang::output_format::binary);
+
+	for (const auto* const name : {"", "Text", "bin", "graph_ids"})
+	{
+		CHECK_FALSE(spang::parse_output_format(name).has_value());
+	}
+}
@@ -0,0 +1,53 @@
+#include <spang/scheduler.hpp>
+
+#include <catch2/catch_test_macros.hpp>
+
+#include <atomic>
+#include <vector>
+
+using spang::task_scheduler;
+
+TEST_CASE("scheduler")
+{
+	SECTION("single thread runs heaviest first")
+	{
+		task_scheduler scheduler{1};
+		std::vector<int> order;
+
+		scheduler.submit(1, [&] { order.push_back(1); });
+		scheduler.submit(5, [&] { order.push_back(5); });
+		scheduler.submit(3,
+		                 [&]
+		                 {
+							 order.push_back(3);
+							 // Submitted while running, ordered against the rest of the queue.
+							 scheduler.submit(4, [&] { order.push_back(4); });
+							 scheduler.submit(0, [&] { order.push_back(0); });
+						 });
+		scheduler.submit(3, [&] { order.push_back(-3); });
+
+		scheduler.run();
+
+		CHECK(order == std::vector{5, 3, 4, -3, 1, 0});
+	}
+
+	SECTION("multiple threads run every task")
+	{
+		task_scheduler scheduler{4};
+		std::atomic<int> count{0};
+
+		for (int i = 0; i < 100; ++i)
+		{
+			scheduler.submit(static_cast<std::size_t>(i),
+			                 [&]
+			                 {
+								 ++count;
+								 scheduler.submit(0, [&] { ++count; });
+							 });
+		}
+
+		scheduler.run();
+
+		CHECK(count == 200);
+	}
+}
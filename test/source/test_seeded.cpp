@@ -0,0 +1,139 @@
+#include <spang/is_min.hpp>
+#include <spang/parser.hpp>
+#include <spang/preprocess.hpp>
+#include <spang/seeded.hpp>
+
+#include "test_graphs.hpp"
+
+#include <catch2/catch_test_macros.hpp>
+
+#include <algorithm>
+#include <span>
+#include <sstream>
+#include <string_view>
+#include <vector>
+
+using spang::dfs_edge_t;
+using spang::parsed_input_graph_t;
+using spang::test::make_path;
+using spang::test::make_star;
+
+namespace
+{
+
+spang::graph_database make_database()
+{
+	std::vector<parsed_input_graph_t> input;
+	input.push_back(make_star(0, 3));
+	input.push_back(make_path(1, 4));
+	input.push_back(make_star(2, 3));
+	input.push_back(make_path(3, 3));
+	return spang::preprocess(std::move(input), 1);
+}
+
+//! The number of edges of each pattern mine_seeded() reports, in increasing order.
+std::vector<std::size_t> mined_sizes(const spang::graph_database& graphs,
+                                     const parsed_input_graph_t& seed,
+                                     const spang::constraints_t& constraints = {})
+{
+	std::ostringstream out;
+	spang::report_sink sink{out};
+	spang::mine_seeded(graphs, seed, 2, spang::report_level::support, constraints, nullptr, sink);
+
+	std::vector<std::size_t> sizes;
+	const auto text = out.str();
+	spang::read_output_graphs(std::string_view{text},
+	                          [&sizes](spang::parsed_output_graph_t&& pattern)
+	                          {
+								  CHECK(pattern.support_count == 2);
+								  sizes.push_back(pattern.edges.size());
+							  });
+	std::ranges::sort(sizes);
+	return sizes;
+}
+
+} // namespace
+
+TEST_CASE("find embeddings")
+{
+	const auto graphs = make_database();
+	const std::span<const spang::compact_graph_t> graphs_span{graphs};
+
+	const dfs_edge_t star_edge{.from = 0, .to = 1, .from_label = 0, .edge_label = 0, .to_label = 1};
+	const auto one_edge = spang::find_embeddings(graphs_span, std::span{&star_edge, 1});
+	CHECK(one_edge.size() == 6);
+	CHECK(one_edge.support() == 2);
+
+	// Two leaves, in either order.
+	const std::vector<dfs_edge_t> two_leaves{
+		star_edge, {.from = 0, .to = 2, .from_label = 0, .edge_label = 0, .to_label = 1}};
+	const auto two_edges = spang::find_embeddings(graphs_span, std::span{two_leaves});
+	CHECK(two_edges.size() == 12);
+	CHECK(two_edges.n_vertices() == 3);
+	for (std::size_t row = 0; row < two_edges.size(); ++row)
+	{
+		const auto vertices = two_edges.vertices(row);
+		CHECK(vertices[1] != vertices[2]);
+	}
+
+	// Both directions of each edge.
+	const dfs_edge_t path_edge{.from = 0, .to = 1, .from_label = 0, .edge_label = 0, .to_label = 0};
+	CHECK(spang::find_embeddings(graphs_span, std::span{&path_edge, 1}).size() == 10);
+
+	// A triangle, which no graph has.
+	const std::vector<dfs_edge_t> triangle{
+		path_edge,
+		{.from = 1, .to = 2, .from_label = 0, .edge_label = 0, .to_label = 0},
+		{.from = 2, .to = 0, .from_label = 0, .edge_label = 0, .to_label = 0},
+	};
+	CHECK(spang::find_embeddings(graphs_span, std::span{triangle}).empty());
+}
+
+TEST_CASE("seed code")
+{
+	// The same path of three vertices, numbered differently.
+	parsed_input_graph_t seed{.id = 0,
+	                          .vertices = {{.id = 0, .label = 1}, {.id = 1, .label = 0},
+	                                       {.id = 2, .label = 2}},
+	                          .edges = {{.from = 1, .to = 2, .label = 0},
+	                                    {.from = 0, .to = 1, .label = 0}}};
+	const auto codes = spang::seed_code(seed);
+	CHECK(codes.size() == 2);
+	CHECK(spang::is_min(codes));
+
+	std::ranges::reverse(seed.edges);
+	CHECK(spang::seed_code(seed) == codes);
+}
+
+TEST_CASE("seeded mining")
+{
+	const auto graphs = make_database();
+
+	SECTION("every pattern containing the seed")
+	{
+		// The leaves are only in the stars, so every pattern is part of a star.
+		CHECK(mined_sizes(graphs, make_star(0, 1)) == std::vector<std::size_t>{1, 2, 3});
+		CHECK(mined_sizes(graphs, make_star(0, 2)) == std::vector<std::size_t>{2, 3});
+	}
+
+	SECTION("patterns containing the seed more than once")
+	{
+		// Each path pattern is reported once, however many ways it contains the seed.
+		CHECK(mined_sizes(graphs, make_path(0, 2)) == std::vector<std::size_t>{1, 2});
+	}
+
+	SECTION("infrequent seed")
+	{
+		CHECK(mined_sizes(graphs, make_star(0, 4)).empty());
+	}
+
+	SECTION("constraints")
+	{
+		spang::constraints_t constraints;
+		constraints.max_degree = 2;
+		CHECK(mined_sizes(graphs, make_star(0, 1), constraints) ==
+		      std::vector<std::size_t>{1, 2});
+		constraints.max_degree = 1;
+		CHECK(mined_sizes(graphs, make_star(0, 2), constraints).empty());
+	}
+}
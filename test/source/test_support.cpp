@@ -0,0 +1,84 @@
+#include <spang/extend.hpp>
+#include <spang/is_min.hpp>
+#include <spang/parser.hpp>
+#include <spang/preprocess.hpp>
+#include <spang/support.hpp>
+
+#include "test_graphs.hpp"
+
+#include <catch2/catch_test_macros.hpp>
+
+#include <span>
+#include <vector>
+
+using spang::dfs_edge_t;
+using spang::parsed_input_graph_t;
+using spang::test::make_path;
+using spang::test::make_star;
+
+TEST_CASE("minimum image based support")
+{
+	spang::mni_counter counter;
+
+	SECTION("star")
+	{
+		std::vector<parsed_input_graph_t> input;
+		input.push_back(make_star(0, 5));
+		const auto graphs = spang::preprocess(std::move(input), 1);
+
+		const auto seeds = spang::extend(graphs);
+		const std::vector<dfs_edge_t> codes{
+			{.from = 0, .to = 1, .from_label = 0, .edge_label = 0, .to_label = 1}};
+		const auto& projections = seeds.at(codes[0]);
+		REQUIRE(projections.size() == 5);
+		// Every embedding maps the first vertex to the centre.
+		CHECK(counter.count(graphs, codes, projections) == 1);
+		CHECK(spang::count_graph_support<spang::vertex_id_t>(projections) == 1);
+
+		// Two leaves: still only the one centre.
+		const auto result = spang::is_min(codes);
+		REQUIRE(result);
+		const auto children = spang::extend(graphs, codes, projections, result->first);
+		const dfs_edge_t child_code{
+			.from = 0, .to = 2, .from_label = 0, .edge_label = 0, .to_label = 1};
+		const auto& child_projections = children.at(child_code);
+		REQUIRE(child_projections.size() == 20);
+		const std::vector child_codes{codes[0], child_code};
+		CHECK(counter.count(graphs, child_codes, child_projections) == 1);
+	}
+
+	SECTION("path")
+	{
+		std::vector<parsed_input_graph_t> input;
+		input.push_back(make_path(0, 6));
+		const auto graphs = spang::preprocess(std::move(input), 1);
+
+		const auto seeds = spang::extend(graphs);
+		const std::vector<dfs_edge_t> codes{
+			{.from = 0, .to = 1, .from_label = 0, .edge_label = 0, .to_label = 0}};
+		// Both directions of each edge, so each vertex is an image of both pattern vertices.
+		CHECK(counter.count(graphs, codes, seeds.at(codes[0])) == 6);
+	}
+
+	SECTION("images in different graphs are distinct")
+	{
+		std::vector<parsed_input_graph_t> input;
+		input.push_back(make_star(0, 3));
+		input.push_back(make_path(1, 4));
+		input.push_back(make_star(2, 5));
+		const auto graphs = spang::preprocess(std::move(input), 1);
+
+		const auto seeds = spang::extend(graphs);
+		const std::vector<dfs_edge_t> codes{
+			{.from = 0, .to = 1, .from_label = 0, .edge_label = 0, .to_label = 1}};
+		const auto& projections = seeds.at(codes[0]);
+		CHECK(counter.count(graphs, codes, projections) == 2);
+		CHECK(spang::count_graph_support<spang::vertex_id_t>(projections) == 2);
+
+		// Reusing the counter starts from scratch.
+		const std::vector<dfs_edge_t> path_codes{
+			{.from = 0, .to = 1, .from_label = 0, .edge_label = 0, .to_label = 0}};
+		CHECK(counter.count(graphs, path_codes, seeds.at(path_codes[0])) == 4);
+		CHECK(counter.count(graphs, codes, projections) == 2);
+	}
+}